@@ -1,15 +1,18 @@
 /*!
  * @file Adafruit_CompositeVideo.cpp
  *
- * @mainpage DMA-driven composite video library for M0 microcontrollers.
+ * @mainpage DMA-driven composite video library for M0 and M4
+ * microcontrollers.
  *
  * @section intro_sec Introduction
  *
- * DMA-driven composite video library for M0 microcontrollers
- * (Circuit Playground Express, Feather M0, Arduino Zero, etc.).
+ * DMA-driven composite video library for M0 (SAMD21) and M4 (SAMD51)
+ * microcontrollers (Circuit Playground Express, Feather M0 and M4,
+ * Arduino Zero, etc.).
  * Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
- * Handles grayscale NTSC video, 40x24 pixels, usable area may be smaller
- * due to overscan.
+ * Handles grayscale NTSC video, 40x24, 40x48, 80x24 or 80x48 pixels, or PAL
+ * video, 40x25 pixels; usable area may be smaller due to overscan. M4
+ * boards also have an experimental 160x96 NTSC mode, Adafruit_NTSC160x96.
  *
  * Adafruit invests time and resources providing this open source code,
  * please support Adafruit and open-source hardware by purchasing
@@ -37,7 +40,21 @@
 #include <Adafruit_CompositeVideo.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_ZeroDMA.h>
-#include <malloc.h> // memalign() function
+#include <glcdfont.c> // Adafruit_GFX's classic 5x7 font, for text mode
+#include <malloc.h>    // memalign() function
+#include <math.h>      // powf() for setGamma()
+
+// Bus address of RAM, flash or a peripheral register for a DMA descriptor,
+// and back. On the SAMD parts that's just the pointer; the host simulator
+// in extras/host_sim, where pointers are 64 bits, supplies its own.
+#ifndef COMPOSITE_DMA_ADDR
+#define COMPOSITE_DMA_ADDR(p) ((uint32_t)(p)) ///< Pointer to DMA address
+#define COMPOSITE_DMA_PTR(a) ((void *)(a))    ///< DMA address to pointer
+#endif
+
+// Option flags that use the line buffer descriptor layout (see begin())
+#define LINEBUFFER_FLAGS                                                       \
+  (COMPOSITE_PACKED4 | COMPOSITE_PACKED8 | COMPOSITE_TEXT)
 
 // The DAC has an option for a 1.0 Volt reference selection (exactly what's
 // needed for composite video) -- but, BUT -- this is NOT used by default.
@@ -49,151 +66,69 @@
 // Allowing space for the sync and blank voltages, there are ~220 available
 // brightness levels (not 256).  GFX functions take care of brightness
 // scaling, so use 0 for black and 255 for white as normal.
-//#define DAC_MAX 1023           ///< Use 1.0 V DAC analog ref
-#define DAC_MAX (1023 * 10 / 33) ///< Use subset of 3.3V DAC
-
-// Currently only one video format & resolution is supported, and maybe
-// that's all that will be implemented.  But if any others happen in the
-// future, this is where they'll start, with a unique index here that
-// points into videoSpec[] table below.
-#define MODE_NTSC40x24 0 ///< NTSC 40x24 pixel mode
+// The SAMD51 DAC is 12 bits rather than 10; all levels are simply 4X.
+#if defined(__SAMD51__)
+#define DAC_BITS 12 ///< DAC resolution
+#else
+#define DAC_BITS 10 ///< DAC resolution
+#endif
+#define DAC_TOP ((1 << DAC_BITS) - 1) ///< Highest DAC value
+//#define DAC_MAX DAC_TOP           ///< Use 1.0 V DAC analog ref
+#define DAC_MAX (DAC_TOP * 10 / 33) ///< Use subset of 3.3V DAC
 
-static const struct {
-  uint16_t timerPeriod;    // CPU ticks per pixel clock (minus 1)
-  uint8_t rowPixelClocks;  // # of pixel clocks (NOT visible pixels) per row
-  uint8_t xOffset;         // Offset in pixel clocks of first visible pixel
-  uint16_t numDescriptors; // Number of DMA descriptors for odd+even fields
-} videoSpec[] = {
-    60, 50, 9, 436, // MODE_NTSC40x24: F_CPU/61 = ~786,885 Hz, ~1.27 uS
-};
+// The vertical sync tables below live in flash, and the DMA reads them
+// from there at the pixel clock, competing with the CPU's own code
+// fetches. Define COMPOSITE_VSYNC_RAM as 1 to instead copy the handful
+// of distinct halflines they're made of to RAM, with a chain of DMA
+// descriptors through them in place of each table (see chainVsync()).
+// Costs about 1.9K of RAM (2.1K for 80-pixel modes, 2.4K for PAL).
+#ifndef COMPOSITE_VSYNC_RAM
+#define COMPOSITE_VSYNC_RAM 0 ///< 1 = vertical sync from RAM
+#endif
 
 // NTSC-SPECIFIC STUFF -----------------------------------------------------
 
 // NTSC sync (NS), blank (N_), black (NK) and white (NW) levels
-#if DAC_MAX == 1023
+#if DAC_MAX == DAC_TOP
 #define IRE(N) (((DAC_MAX * (40 + N)) + 70) / 140)
 static const uint16_t NS = IRE(-40), N_ = IRE(0), NK = IRE(8), NW = IRE(100);
 #else
 // Better (?) sync & ref black voltages:
-static const uint16_t NS = 0, N_ = 45, NK = 60, NW = 310;
-#endif
-
-// Adafruit_CompositeVideo class -------------------------------------------
-//
-// User code should not need to instantiate objects of this class.
-// It's a parent class for the resolution-specific class(es) that appear
-// later in the code.  It's done this way because the Adafruit_GFX
-// constructor requires width & height values from the get-go.
-
-// Constructor
-Adafruit_CompositeVideo::Adafruit_CompositeVideo(uint8_t mode, int16_t width,
-                                                 int16_t height)
-    : Adafruit_GFX(width, height), mode(mode), descriptor(NULL) {}
-
-boolean Adafruit_CompositeVideo::begin(void) {
-  if (descriptor)
-    return true; // Don't double-init!
-
-  // DMA init --------------------------------------------------------------
-
-  dma.setTrigger(TC5_DMAC_ID_OVF);
-  dma.setAction(DMA_TRIGGER_ACTON_BEAT);
-  if (dma.allocate() != DMA_STATUS_OK)
-    return false;
-
-  // Big allocation --------------------------------------------------------
-
-  // DMA descriptor list MUST be 128-bit (16 byte) aligned!
-  if (!(descriptor = (DmacDescriptor *)memalign(
-            16,
-            sizeof(DmacDescriptor) * videoSpec[mode].numDescriptors +
-                sizeof(uint16_t) * videoSpec[mode].rowPixelClocks * HEIGHT)))
-    return false;
-
-  // Frame buffer follows descriptor list.
-  frameBuffer = (uint16_t *)&descriptor[videoSpec[mode].numDescriptors];
-
-  // Timer init ------------------------------------------------------------
-  // TC5 is used; this will knock out the Tone library
-
-  GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 |
-                                 GCLK_CLKCTRL_ID(GCM_TC4_TC5));
-  while (GCLK->STATUS.bit.SYNCBUSY == 1)
-    ;
-
-  TC5->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE; // Disable TCx to config it
-  while (TC5->COUNT16.STATUS.bit.SYNCBUSY)
-    ;
-
-  TC5->COUNT16.CTRLA.reg =     // Configure timer counter
-      TC_CTRLA_MODE_COUNT16 |  // 16-bit counter mode
-      TC_CTRLA_WAVEGEN_MFRQ |  // Match Frequency mode
-      TC_CTRLA_PRESCALER_DIV1; // 1:1 Prescale
-  while (TC5->COUNT16.STATUS.bit.SYNCBUSY)
-    ;
-
-  TC5->COUNT16.CC[0].reg = videoSpec[mode].timerPeriod;
-  while (TC5->COUNT16.STATUS.bit.SYNCBUSY)
-    ;
-
-  TC5->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE; // Re-enable TCx
-  while (TC5->COUNT16.STATUS.bit.SYNCBUSY)
-    ;
-
-    // DAC INIT --------------------------------------------------------------
-
-#ifdef ADAFRUIT_CIRCUITPLAYGROUND_M0
-  pinMode(11, OUTPUT);
-  digitalWrite(11, LOW); // Switch off speaker (DAC to A0 pin only)
+static const uint16_t NS = 0, N_ = 45 << (DAC_BITS - 10),
+                      NK = 60 << (DAC_BITS - 10), NW = DAC_MAX;
 #endif
-  analogWriteResolution(10); // Let Arduino core initialize the DAC,
-  analogWrite(A0, 512);      // ain't nobody got time for that!
-#if DAC_MAX == 1023
-  DAC->CTRLB.bit.REFSEL = 0; // VMAX = 1.0V
-  while (DAC->STATUS.bit.SYNCBUSY)
-    ;
-#endif
-
-  // DMA transfer job is NOT started here!  That's done in subclass
-  // begin() function, after descriptor table is filled.
-
-  return true;
-}
-
-// ALL-PURPOSE GFX PIXEL DRAWING FUNCTION ----------------------------------
 
-void Adafruit_CompositeVideo::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
-    return;
+// Gray-to-DAC lookup table, mapping GFX brightness (0-255) to DAC values
+// (NK-NW), so drawing never needs a divide (which the M0 does not have in
+// hardware). Built at compile time, lives in flash (512 bytes). setLevels()
+// and setGamma() build a replacement in RAM instead; grayLUT and nibbleLUT
+// point to whichever is in use.
+#define G2D(n) (uint16_t)(NK + (n) * (NW - NK) / 255)
+#define G2D4(n) G2D(n), G2D(n + 1), G2D(n + 2), G2D(n + 3)
+#define G2D16(n) G2D4(n), G2D4(n + 4), G2D4(n + 8), G2D4(n + 12)
+#define G2D64(n) G2D16(n), G2D16(n + 16), G2D16(n + 32), G2D16(n + 48)
+static const uint16_t defaultGrayLUT[256] = {G2D64(0), G2D64(64),
+                                             G2D64(128), G2D64(192)};
 
-  int16_t t;
-  switch (rotation) {
-  case 1:
-    t = x;
-    x = WIDTH - 1 - y;
-    y = t;
-    break;
-  case 2:
-    x = WIDTH - 1 - x;
-    y = HEIGHT - 1 - y;
-    break;
-  case 3:
-    t = x;
-    x = y;
-    y = HEIGHT - 1 - t;
-    break;
-  }
+// Same for 4-bit packed framebuffers (COMPOSITE_PACKED4), 0-15.
+#define N2D(n) G2D((n)*17)
+#define N2D4(n) N2D(n), N2D(n + 1), N2D(n + 2), N2D(n + 3)
+static const uint16_t defaultNibbleLUT[16] = {N2D4(0), N2D4(4), N2D4(8),
+                                              N2D4(12)};
 
-  frameBuffer[y * videoSpec[mode].rowPixelClocks + x +
-              videoSpec[mode].xOffset] = NK + (color & 0xFF) * (NW - NK) / 255;
-}
+static const uint16_t *grayLUT = defaultGrayLUT;     // Current tables,
+static const uint16_t *nibbleLUT = defaultNibbleLUT; // flash or RAM
+static uint16_t blackLevel = NK, whiteLevel = NW;    // See setLevels()
+static float gammaValue = 1.0;                       // See setGamma()
 
-// NTSC 40x24-SPECIFIC STUFF -----------------------------------------------
+// NTSC SYNC TABLES --------------------------------------------------------
 
 // Some pixel clock arrangements for the vertical sync and overscan lines:
 // 25 and 50 in this case refer to the total number of pixel clocks per
 // line, which includes horizontal sync and overscan.  The available drawable
-// raster size is narrower than this (40 pixels).
+// raster size is narrower than this (40 pixels).  Visible lines (and the
+// framebuffer rows) are the same as a blank line, but with black (NK) in
+// the visible span, between xOffset and xOffset + width (see initRow()).
 #define NTSC_EQ_HALFLINE25                                                     \
   NS, NS, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_,  \
       N_, N_, N_, N_, N_, N_ ///< One-half vsync scanline
@@ -204,12 +139,6 @@ void Adafruit_CompositeVideo::drawPixel(int16_t x, int16_t y, uint16_t color) {
   NS, NS, NS, NS, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_,  \
       N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_,  \
       N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_, N_ ///< Full line blank
-#define NTSC_EMPTY_LINE50                                                      \
-  NS, NS, NS, NS, N_, N_, N_, N_, N_, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK,  \
-      NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK,  \
-      NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, NK, N_ ///< Full line black
-
-// NTSC sync (NS), blank (N_), black (NK) and white (NW) levels
 
 // Pixel clocking data for the whole odd & even vertical sync periods...
 static const uint16_t
@@ -285,34 +214,628 @@ static const uint16_t
         // Pixel data then occupies lines 294-509 (216 lines; 24*9)
 };
 
-// Until if/when proper double-buffering is implemented, this is a
-// Kludgey McKludgeface thing for polling for odd/even vertical sync
-// events.  Don't get comfortable with it, this is going away.
+// Equivalent lines for modes with 102 pixel clocks per line (0.625 uS
+// each, twice the 40-pixel rate, +0.3% line period), built with some
+// repetition helpers rather than spelling out every value:
+#define X2(v) v, v
+#define X4(v) X2(v), X2(v)
+#define X8(v) X4(v), X4(v)
+#define X16(v) X8(v), X8(v)
+#define X32(v) X16(v), X16(v)
+#define NTSC_EQ_HALFLINE51                                                     \
+  X4(NS), X32(N_), X8(N_), X4(N_), X2(N_), N_ ///< One-half vsync scanline
+#define NTSC_SERRATION_HALFLINE51                                              \
+  X32(NS), X8(NS), X4(NS), X4(N_), X2(N_), N_ ///< Other half vsync scanline
+#define NTSC_HALFBLANK51                                                       \
+  X8(NS), X32(N_), X8(N_), X2(N_), N_ ///< First half of a blank line
+#define NTSC_BLANK_LINE102                                                     \
+  X8(NS), X32(N_), X32(N_), X16(N_), X8(N_), X4(N_), X2(N_) ///< Blank line
+
+// Same again for the 102-pixel-clock modes (80x24, 80x48)...
+static const uint16_t
+    NTSC80vsyncOdd[] =
+        {
+            // These 16 blank lines (510-525) are the bottom of the *prior*
+            // (even)
+            // field, merged here to save on DMA descriptors:
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102,
+            // The vertical blank for odd fields then actually starts here:
+            NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, // Line 1
+            NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51,
+            NTSC_EQ_HALFLINE51, NTSC_SERRATION_HALFLINE51,
+            NTSC_SERRATION_HALFLINE51, NTSC_SERRATION_HALFLINE51,
+            NTSC_SERRATION_HALFLINE51, NTSC_SERRATION_HALFLINE51,
+            NTSC_SERRATION_HALFLINE51, NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51,
+            NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51,
+            NTSC_EQ_HALFLINE51, // Line 9
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, // Lines 10-20
+                               // The 11 lines above (10-20) are part of the
+                               // vertical blank. Video at top of field could
+                               // then start...but the next 10 lines here are
+                               // also blank to center the 24-row pixel data
+                               // vertically:
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+            NTSC_BLANK_LINE102 // Lines 21-30
+                              // Pixel data then occupies lines 31-246 (216
+                              // lines; 24*9)
+},
+    NTSC80vsyncEven[] = {
+        // These 16 blank lines (247-262) are the bottom of the *prior* (odd)
+        // field, merged here to save on DMA descriptors:
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102,
+        // Line 263 before vblank is an odd half-line of image and half EQ:
+        NTSC_HALFBLANK51, NTSC_EQ_HALFLINE51,
+        // Vertical blank for even fields then starts here:
+        NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, // Line 264
+        NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51,
+        NTSC_SERRATION_HALFLINE51, NTSC_SERRATION_HALFLINE51,
+        NTSC_SERRATION_HALFLINE51, NTSC_SERRATION_HALFLINE51,
+        NTSC_SERRATION_HALFLINE51, NTSC_SERRATION_HALFLINE51,
+        NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51,
+        NTSC_EQ_HALFLINE51, NTSC_EQ_HALFLINE51, // Line 271
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, // 272-282
+        // Line 283 is another weird half-line at the top of the new field,
+        // but since we have no pixel data up this high, a blank line works:
+        NTSC_BLANK_LINE102,
+        // Next 10 lines (284-293) are blank to v-center the 24-row pixel data:
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102, NTSC_BLANK_LINE102, NTSC_BLANK_LINE102,
+        NTSC_BLANK_LINE102
+        // Pixel data then occupies lines 294-509 (216 lines; 24*9)
+};
+
+#if defined(__SAMD51__)
+// Lines for the 204-pixel-clock mode (160x96, SAMD51 only), each value of
+// the 102-clock lines doubled. A second set of repetition helpers handles
+// whole lines, which expand to comma-separated lists (hence variadic).
+#define X64(v) X32(v), X32(v)
+#define NTSC_EQ_HALFLINE102                                                    \
+  X8(NS), X64(N_), X16(N_), X8(N_), X4(N_), X2(N_) ///< One-half vsync line
+#define NTSC_SERRATION_HALFLINE102                                             \
+  X64(NS), X16(NS), X8(NS), X8(N_), X4(N_), X2(N_) ///< Other half vsync line
+#define NTSC_HALFBLANK102                                                      \
+  X16(NS), X64(N_), X16(N_), X4(N_), X2(N_) ///< First half of a blank line
+#define NTSC_BLANK_LINE204                                                     \
+  X16(NS), X64(N_), X64(N_), X32(N_), X16(N_), X8(N_), X4(N_) ///< Blank line
+#define L2(...) __VA_ARGS__, __VA_ARGS__
+#define L3(...) __VA_ARGS__, __VA_ARGS__, __VA_ARGS__
+#define L5(...) L2(__VA_ARGS__), L3(__VA_ARGS__)
+#define L6(...) L3(__VA_ARGS__), L3(__VA_ARGS__)
+#define L10(...) L5(__VA_ARGS__), L5(__VA_ARGS__)
+
+static const uint16_t NTSC160vsyncOdd[] =
+    {
+        // Lines 510-525, bottom of the prior field as above:
+        L10(NTSC_BLANK_LINE204), L6(NTSC_BLANK_LINE204),
+        L6(NTSC_EQ_HALFLINE102),         // Lines 1-3
+        L6(NTSC_SERRATION_HALFLINE102),  // Lines 4-6
+        L6(NTSC_EQ_HALFLINE102),         // Lines 7-9
+        L10(NTSC_BLANK_LINE204), L10(NTSC_BLANK_LINE204),
+        NTSC_BLANK_LINE204 // Lines 10-30
+                           // Pixel data then occupies lines 31-246
+},
+                      NTSC160vsyncEven[] = {
+                          // Lines 247-262, bottom of the prior field:
+                          L10(NTSC_BLANK_LINE204), L6(NTSC_BLANK_LINE204),
+                          NTSC_HALFBLANK102, NTSC_EQ_HALFLINE102, // Line 263
+                          L5(NTSC_EQ_HALFLINE102),
+                          L6(NTSC_SERRATION_HALFLINE102),
+                          L5(NTSC_EQ_HALFLINE102), // Lines 264-271
+                          L10(NTSC_BLANK_LINE204), L10(NTSC_BLANK_LINE204),
+                          L2(NTSC_BLANK_LINE204) // Lines 272-293
+                          // Pixel data then occupies lines 294-509
+};
+#endif // __SAMD51__
+
+// PAL SYNC TABLES ---------------------------------------------------------
+
+// PAL lines are 64 uS; at 48 MHz/64 that's exactly 48 pixel clocks of
+// 1.333 uS (4 sync, 3 back porch, 40 visible, 1 front porch), so there's
+// no line rate error at all. The same DAC levels as NTSC are used; PAL
+// has no 'setup' (black and blank are the same level), so black here is
+// a few IRE above spec, a very dark gray at worst.
+#define PAL_EQ_HALFLINE24                                                      \
+  X2(NS), X16(N_), X4(N_), X2(N_) ///< Equalizing (short) pulse half-line
+#define PAL_BROAD_HALFLINE24                                                   \
+  X16(NS), X4(NS), X4(N_) ///< Broad (long) vsync pulse half-line
+#define PAL_HALFBLANK24                                                        \
+  X4(NS), X16(N_), X4(N_) ///< First half of a blank line (with hsync)
+#define PAL_HALFLEVEL24 X16(N_), X8(N_) ///< Second half of a blank line
+#define PAL_BLANK_LINE48                                                       \
+  X4(NS), X32(N_), X8(N_), X4(N_) ///< Full line blank
+
+// 625 lines, 312.5 per field. Visible lines are 23.5-310 and 336-622.5;
+// 250 of each field's lines (25 rows * 10) are used for pixel data,
+// centered in that area.
+static const uint16_t
+    PAL40x25vsyncOdd[] =
+        {
+            // These 18 blank lines (605-622) are the bottom of the *prior*
+            // (even) field, merged here to save on DMA descriptors:
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            // Line 623 is half blank, then 5 pre-equalizing pulses
+            // (623-625), 5 broad pulses (1-3) and 5 post-equalizing
+            // pulses (3-5):
+            PAL_HALFBLANK24, PAL_EQ_HALFLINE24, // Line 623
+            PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24,
+            PAL_EQ_HALFLINE24, PAL_BROAD_HALFLINE24, // Line 1
+            PAL_BROAD_HALFLINE24, PAL_BROAD_HALFLINE24, PAL_BROAD_HALFLINE24,
+            PAL_BROAD_HALFLINE24, PAL_EQ_HALFLINE24, // Line 3
+            PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24,
+            PAL_EQ_HALFLINE24, // Line 5
+            // Lines 6-22 are the rest of the vertical blank, then 23-41
+            // are also blank to center the 25-row pixel data vertically:
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+            PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48
+            // Pixel data then occupies lines 42-291 (250 lines; 25*10)
+},
+    PAL40x25vsyncEven[] = {
+        // These 19 blank lines (292-310) are the bottom of the *prior* (odd)
+        // field, merged here to save on DMA descriptors:
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48,
+        // 5 pre-equalizing pulses (311-313), 5 broad pulses (313-315) and
+        // 5 post-equalizing pulses (316-318), then half a blank line:
+        PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24,
+        PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24, PAL_BROAD_HALFLINE24, // 313
+        PAL_BROAD_HALFLINE24, PAL_BROAD_HALFLINE24, PAL_BROAD_HALFLINE24,
+        PAL_BROAD_HALFLINE24, PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24,
+        PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24, PAL_EQ_HALFLINE24,
+        PAL_HALFLEVEL24, // Line 318
+        // Lines 319-335 are the rest of the vertical blank, then 336-354
+        // are also blank to center the 25-row pixel data vertically:
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48,
+        PAL_BLANK_LINE48, PAL_BLANK_LINE48, PAL_BLANK_LINE48
+        // Pixel data then occupies lines 355-604 (250 lines; 25*10)
+};
+
+// Video formats & resolutions, each with a unique index here that points
+// into the videoSpec[] table below.
+#define MODE_NTSC40x24 0 ///< NTSC 40x24 pixel mode
+#define MODE_NTSC80x24 1 ///< NTSC 80x24 pixel mode
+#define MODE_NTSC80x48 2 ///< NTSC 80x48 pixel mode
+#define MODE_PAL40x25 3  ///< PAL 40x25 pixel mode
+#define MODE_NTSC40x48 4 ///< NTSC 40x48 pixel mode
+#define MODE_NTSC160x96 5 ///< NTSC 160x96 pixel mode (SAMD51 only)
+
+// Timer periods below are in ticks of a 48 MHz clock (F_CPU on SAMD21),
+// and rescaled for the clock actually used (see setTimer()).
+#define TIMING_HZ 48000000
+
+static const struct {
+  uint16_t timerPeriod;     // TIMING_HZ ticks per pixel clock (minus 1)
+  uint8_t rowPixelClocks;   // # of pixel clocks (NOT visible pixels) per row
+  uint8_t xOffset;          // Offset in pixel clocks of first visible pixel
+  uint16_t scanlines;       // # of visible scanlines per field
+  const uint16_t *vsync[2]; // Odd & even field vertical sync tables
+  uint16_t vsyncLen[2];     // # of pixel clocks in each vsync table
+} videoSpec[] = {
+    // MODE_NTSC40x24: 48 MHz/61 = ~786,885 Hz, ~1.27 uS
+    {60,
+     50,
+     9,
+     216,
+     {NTSC40x24vsyncOdd, NTSC40x24vsyncEven},
+     {sizeof NTSC40x24vsyncOdd / 2, sizeof NTSC40x24vsyncEven / 2}},
+    // MODE_NTSC80x24: 48 MHz/30 = 1.6 MHz, 0.625 uS
+    {29,
+     102,
+     18,
+     216,
+     {NTSC80vsyncOdd, NTSC80vsyncEven},
+     {sizeof NTSC80vsyncOdd / 2, sizeof NTSC80vsyncEven / 2}},
+    // MODE_NTSC80x48: same timing, twice the rows
+    {29,
+     102,
+     18,
+     216,
+     {NTSC80vsyncOdd, NTSC80vsyncEven},
+     {sizeof NTSC80vsyncOdd / 2, sizeof NTSC80vsyncEven / 2}},
+    // MODE_PAL40x25: 48 MHz/64 = 750 KHz, 1.333 uS
+    {63,
+     48,
+     7,
+     250,
+     {PAL40x25vsyncOdd, PAL40x25vsyncEven},
+     {sizeof PAL40x25vsyncOdd / 2, sizeof PAL40x25vsyncEven / 2}},
+    // MODE_NTSC40x48: same timing as 40x24, twice the rows
+    {60,
+     50,
+     9,
+     216,
+     {NTSC40x24vsyncOdd, NTSC40x24vsyncEven},
+     {sizeof NTSC40x24vsyncOdd / 2, sizeof NTSC40x24vsyncEven / 2}},
+#if defined(__SAMD51__)
+    // MODE_NTSC160x96: 48 MHz/15 = 3.2 MHz, 0.3125 uS
+    {14,
+     204,
+     36,
+     216,
+     {NTSC160vsyncOdd, NTSC160vsyncEven},
+     {sizeof NTSC160vsyncOdd / 2, sizeof NTSC160vsyncEven / 2}},
+#endif
+};
+
+// Timers that can pace the DMA, indexed by COMPOSITE_TC3 etc. Each is
+// either a Timer/Counter or a TCC; generic clocks go to pairs of them.
+// On SAMD51 each also has its own bus clock enable in MCLK, and smaller
+// parts lack TC4 and TC5 (those entries are left empty; see setTimer()).
+static const struct {
+  Tc *tc;          // Timer/Counter, or NULL if a TCC
+  Tcc *tcc;        // TCC, or NULL if a Timer/Counter
+  uint8_t clockID; // Generic clock multiplexer/peripheral channel ID
+  uint8_t trigger; // DMA trigger, on overflow
+#if defined(__SAMD51__)
+  volatile uint32_t *apbMask; // MCLK APBxMASK register
+  uint32_t apbBit;            // and bit for this timer
+} timerSpec[] = {
+    {TC3, NULL, TC3_GCLK_ID, TC3_DMAC_ID_OVF, &MCLK->APBBMASK.reg,
+     MCLK_APBBMASK_TC3},
+#if defined(TC4)
+    {TC4, NULL, TC4_GCLK_ID, TC4_DMAC_ID_OVF, &MCLK->APBCMASK.reg,
+     MCLK_APBCMASK_TC4},
+#else
+    {NULL, NULL, 0, 0, NULL, 0},
+#endif
+#if defined(TC5)
+    {TC5, NULL, TC5_GCLK_ID, TC5_DMAC_ID_OVF, &MCLK->APBCMASK.reg,
+     MCLK_APBCMASK_TC5},
+#else
+    {NULL, NULL, 0, 0, NULL, 0},
+#endif
+    {NULL, TCC0, TCC0_GCLK_ID, TCC0_DMAC_ID_OVF, &MCLK->APBBMASK.reg,
+     MCLK_APBBMASK_TCC0},
+    {NULL, TCC1, TCC1_GCLK_ID, TCC1_DMAC_ID_OVF, &MCLK->APBBMASK.reg,
+     MCLK_APBBMASK_TCC1},
+    {NULL, TCC2, TCC2_GCLK_ID, TCC2_DMAC_ID_OVF, &MCLK->APBCMASK.reg,
+     MCLK_APBCMASK_TCC2},
+};
+#else
+} timerSpec[] = {
+    {TC3, NULL, GCM_TCC2_TC3, TC3_DMAC_ID_OVF},
+    {TC4, NULL, GCM_TC4_TC5, TC4_DMAC_ID_OVF},
+    {TC5, NULL, GCM_TC4_TC5, TC5_DMAC_ID_OVF},
+    {NULL, TCC0, GCM_TCC0_TCC1, TCC0_DMAC_ID_OVF},
+    {NULL, TCC1, GCM_TCC0_TCC1, TCC1_DMAC_ID_OVF},
+    {NULL, TCC2, GCM_TCC2_TC3, TCC2_DMAC_ID_OVF},
+};
+#endif
+
+// Wait for a Timer/Counter's registers to sync, which has its own
+// register on SAMD51 and is a status bit on SAMD21.
+static void tcSync(Tc *tc) {
+#if defined(__SAMD51__)
+  while (tc->COUNT16.SYNCBUSY.reg)
+    ;
+#else
+  while (tc->COUNT16.STATUS.bit.SYNCBUSY)
+    ;
+#endif
+}
+
+// Field index, DMA'd to fieldEnd at the end of each field's pixel data by
+// descriptors in the list (these also raise the DMA interrupt, which then
+// clears fieldEnd and copies it to vBlank for getBlank()). Packed modes
+// also interrupt at the end of every scanline; fieldEnd distinguishes the
+// two cases.
 volatile uint8_t vBlank = 0; ///< Current field index
+static volatile uint8_t fieldEnd = 0;
 static const uint8_t vBlank1 = 1, vBlank2 = 2;
 
-// Adafruit_NTSC40x24 class ------------------------------------------------
+#if COMPOSITE_VSYNC_RAM
+// The vsync tables are built from a few distinct halflines (equalizing
+// pulses, serrations, blank...), each repeated many times. Those are
+// found here and copied to RAM once each (only one video object can be
+// active, so this list can be static).
+#define MAX_HALFLINES 16
+static const uint16_t *halfline[MAX_HALFLINES]; // Distinct halflines
+static uint8_t numHalflines;
+
+// Index in halfline[] of the halfline matching src, adding it if new.
+// Returns MAX_HALFLINES if there's no room.
+static uint8_t findHalfline(const uint16_t *src, uint8_t hl) {
+  for (uint8_t k = 0; k < numHalflines; k++) {
+    if (!memcmp(halfline[k], src, hl * sizeof(uint16_t)))
+      return k;
+  }
+  if (numHalflines >= MAX_HALFLINES)
+    return MAX_HALFLINES;
+  halfline[numHalflines] = src;
+  return numHalflines++;
+}
+#endif // COMPOSITE_VSYNC_RAM
+
+// There's only one DAC, so only one video object can be active at a time.
+// This is the one the DMA interrupt callback applies to.
+static Adafruit_CompositeVideo *activeVideo = NULL;
+
+// Adafruit_CompositeVideo class -------------------------------------------
 //
-// THIS is what user code instantiates.
+// User code should not need to instantiate objects of this class.
+// It's a parent class for the resolution-specific class(es) that appear
+// later in the code.  It's done this way because the Adafruit_GFX
+// constructor requires width & height values from the get-go.  All of
+// the actual work happens here though, as directed by videoSpec[mode].
 
 // Constructor
-Adafruit_NTSC40x24::Adafruit_NTSC40x24()
-    : Adafruit_CompositeVideo(MODE_NTSC40x24, 40, 24) {}
+Adafruit_CompositeVideo::Adafruit_CompositeVideo(uint8_t mode, int16_t width,
+                                                 int16_t height)
+    : Adafruit_GFX(width, height), mode(mode), flags(0), timer(COMPOSITE_TIMER),
+      clockGen(COMPOSITE_GCLK), clockHz(COMPOSITE_GCLK_HZ),
+      pixelWriter(&Adafruit_CompositeVideo::rotatedPixel<0>), descriptor(NULL),
+      numDescriptors(0), allocated(0), primed(false), frameBuffer(NULL),
+      frontBuffer(NULL), packedBuffer(NULL), packedFront(NULL),
+      vBlankCallback(NULL), fieldCount(0), swapPending(false), swapCopy(false),
+      scrollX(0), scrollY(0), viewX(0), viewY(0), raster(NULL),
+      rasterNext(NULL), scrollPending(false), lineField(0), rowLines(0),
+      rowTop(0), rowLinesNext(0), rowTopNext(0), emphasis(0), vsyncChain(NULL),
+      vsyncPool(NULL), vsyncDescs(0), fieldMicros(0), lastFieldMicros(0),
+      spritePending(false) {
+  memset(&stats, 0, sizeof stats);
+  memset(sprite, 0, sizeof sprite);
+  memset(spriteNext, 0, sizeof spriteNext);
+}
+
+boolean Adafruit_CompositeVideo::begin(uint8_t flags) {
+  // Calling begin() again restarts with new flags, and starting another
+  // object stops this one (there's only one DAC).
+  if (activeVideo)
+    activeVideo->end();
+
+  this->flags = flags;
 
-// begin() sets up DMA descriptor table
-boolean Adafruit_NTSC40x24::begin(void) {
-  if (!Adafruit_CompositeVideo::begin())
+  // FYI, the DMA descriptor table is what uses most of the memory here.
+  // With L visible scanlines per field (216 for NTSC), the normal layout
+  // has separate odd and even field lists:
+  //   0 = odd field vsync, 1 to L = pixel data, L+1 = end of odd field,
+  //   L+2 = even field vsync, L+3 to 2L+2 = pixel data, 2L+3 = end of even
+  // For NTSC40x24 that's 436 entries * 16 bytes each = 6976 bytes. The
+  // framebuffer (actually 50 pixel clocks wide) is 50 words (2 bytes ea)
+  // * 24 lines = 2400 bytes. 6976 + 2400 = 9376 bytes! (Another 2400 if
+  // double-buffered.) The COMPOSITE_COMPACT layout shares one set of
+  // pixel descriptors between both fields:
+  //   0 = odd field vsync, 1 = even field vsync, 2 to L+1 = pixel data,
+  //   L+2 = end of field,
+  // with the end-of-field interrupt re-linking that last descriptor to
+  // the opposite field's vsync each time. 219 * 16 + 2400 = 5904 bytes.
+  // Packed modes (COMPOSITE_PACKED4 or 8) need only five descriptors,
+  // looping over two line buffers that the DMA interrupt refills from
+  // the packed framebuffer:
+  //   0 = odd field vsync, 1 = even field vsync, 2 = line buffer A,
+  //   3 = line buffer B, 4 = end of field.
+  // For NTSC40x24 with 8 bits/pixel that's 80 + 200 + 960 = 1240 bytes.
+  // COMPOSITE_TEXT works the same way, but the 'packed framebuffer' is
+  // one byte per 6x8 pixel character cell: 80 + 200 + 18 = 298 bytes.
+  // Why not a separate DMA channel for sync & blanking, with the big list
+  // only for visible pixels? There's one DAC, and channels are arbitrated
+  // beat by beat in no fixed order, so two channels can't take turns at
+  // it with pixel clock precision. Nor would it save bus time: the DMA
+  // fetches one 16-byte descriptor per scanline in every layout (~200K/s
+  // next to ~1.6M/s of pixel data at 40x24), and splitting each line
+  // into sync and pixel blocks would double that. Vertical sync already
+  // comes straight from flash, not SRAM. So the layouts trade RAM, not
+  // bandwidth; the lean ones are packed & text modes. Other DMA users
+  // needing low latency can be given a higher priority than video's
+  // (level 0), which only needs one beat per pixel clock.
+  uint16_t lines = videoSpec[mode].scanlines;
+  if (flags & LINEBUFFER_FLAGS)
+    numDescriptors = 5;
+  else if (flags & COMPOSITE_COMPACT)
+    numDescriptors = lines + 3;
+  else
+    numDescriptors = lines * 2 + 4;
+
+  // DMA init --------------------------------------------------------------
+
+  dma.setTrigger(timerSpec[timer].trigger);
+  dma.setAction(DMA_TRIGGER_ACTON_BEAT);
+  if (dma.allocate() != DMA_STATUS_OK)
     return false;
+  // Descriptors with BLOCKACT_INT raise the transfer-complete interrupt
+  // as they finish, while the job itself keeps running.
+  dma.setCallback(dmaCallback, DMA_CALLBACK_TRANSFER_DONE);
+  dma.setCallback(dmaErrorCallback, DMA_CALLBACK_TRANSFER_ERROR);
+  activeVideo = this;
+
+  // Pixel clock in ticks of the timer's clock, as near as possible to
+  // the mode's timing at TIMING_HZ (so a faster clock allows finer steps)
+  uint64_t ticks = (uint64_t)(videoSpec[mode].timerPeriod + 1) * clockHz;
+  uint32_t period = (ticks + TIMING_HZ / 2) / TIMING_HZ - 1;
 
-  // FYI, the DMA descriptor table is what uses all the memory here.
-  // 436 entries * 20 bytes each = 8720 bytes (+ 1 for word alignment).
-  // Framebuffer for NTSC40x24 mode (actually 50 pixel clocks wide)
-  // is 50 words (2 bytes ea) * 24 lines = 2400 bytes.
-  // 8720 + 1 + 2400 = 11,121 bytes!
+  // Statistics, see getStats(). Field duration (average of odd & even)
+  // is used to count fields that ended without an interrupt handled.
+  fieldMicros = (((uint32_t)videoSpec[mode].vsyncLen[0] +
+                  videoSpec[mode].vsyncLen[1]) / 2 +
+                 (uint32_t)videoSpec[mode].scanlines *
+                     videoSpec[mode].rowPixelClocks) *
+                (uint64_t)(period + 1) * 1000000 / clockHz;
+  lastFieldMicros = 0;
+  resetStats();
+
+  // Big allocation --------------------------------------------------------
 
+  // DMA descriptor list MUST be 128-bit (16 byte) aligned!
+  uint8_t numBuffers = (flags & COMPOSITE_DOUBLEBUFFER) ? 2 : 1;
+  uint32_t bufferSize = videoSpec[mode].rowPixelClocks * HEIGHT; // words
+  uint32_t packedSize = packedBytes();                           // bytes
+  if (packedSize)
+    bufferSize = videoSpec[mode].rowPixelClocks * 2; // Just 2 line buffers
+  uint32_t bytes = sizeof(DmacDescriptor) * numDescriptors;
+#if COMPOSITE_VSYNC_RAM
+  // Vsync chains (less the first descriptor of each, which is in the
+  // list as usual) follow the list, then the halflines, padded to a
+  // whole number of 32-bit words so the buffers after stay word-aligned.
+  uint8_t hl = videoSpec[mode].rowPixelClocks / 2;
+  uint16_t poolWords = findHalflines() * hl;
+  vsyncDescs = poolWords ? chainVsync(0, NULL, NULL) - 1 +
+                               chainVsync(1, NULL, NULL) - 1
+                         : 0;
+  bytes += sizeof(DmacDescriptor) * vsyncDescs +
+           sizeof(uint16_t) * ((poolWords + 1) & ~1);
+#endif
+  if (packedSize)
+    bytes += sizeof(uint16_t) * bufferSize + packedSize * numBuffers;
+  else
+    bytes += sizeof(uint16_t) * bufferSize * numBuffers;
+  if (!(descriptor = (DmacDescriptor *)memalign(16, bytes))) {
+    (void)dma.free();
+    activeVideo = NULL;
+    return false;
+  }
+  allocated = bytes;
+
+  // Frame buffer(s) follow descriptor list. If double-buffered, DMA
+  // starts out showing the first and drawing happens in the second.
+  // In packed modes, frameBuffer and frontBuffer are both the pair of
+  // line buffers, and the packed framebuffer(s) follow those.
+  frontBuffer = (uint16_t *)&descriptor[numDescriptors];
+#if COMPOSITE_VSYNC_RAM
+  vsyncChain = &descriptor[numDescriptors];
+  vsyncPool = (uint16_t *)&vsyncChain[vsyncDescs];
+  frontBuffer = &vsyncPool[(poolWords + 1) & ~1];
+  if (!poolWords)
+    vsyncPool = NULL; // Too many halflines, vsync stays in flash
+  for (uint16_t i = 0; i < poolWords; i += hl)
+    memcpy(&vsyncPool[i], halfline[i / hl], hl * sizeof(uint16_t));
+#endif
+  if (packedSize) {
+    frameBuffer = frontBuffer;
+    packedFront = (uint8_t *)&frontBuffer[bufferSize];
+    packedBuffer = &packedFront[packedSize * (numBuffers - 1)];
+  } else {
+    frameBuffer = &frontBuffer[bufferSize * (numBuffers - 1)];
+  }
+
+  startTimer(period);
+
+    // DAC INIT --------------------------------------------------------------
+
+#ifdef ADAFRUIT_CIRCUITPLAYGROUND_M0
+  pinMode(11, OUTPUT);
+  digitalWrite(11, LOW); // Switch off speaker (DAC to A0 pin only)
+#endif
+  analogWriteResolution(DAC_BITS);     // Let Arduino core initialize
+  analogWrite(A0, 1 << (DAC_BITS - 1)); // the DAC, ain't nobody got time!
+#if defined(__SAMD51__)
+  // Fastest conversions, and 1.0 V reference if selected. These settings
+  // can only change with the DAC disabled.
+  DAC->CTRLA.bit.ENABLE = 0;
+  while (DAC->SYNCBUSY.bit.ENABLE)
+    ;
+  DAC->DACCTRL[0].bit.CCTRL = DAC_DACCTRL_CCTRL_CC12M_Val;
+#if DAC_MAX == DAC_TOP
+  DAC->CTRLB.bit.REFSEL = DAC_CTRLB_REFSEL_INTREF_Val; // VMAX = 1.0V
+#endif
+  DAC->CTRLA.bit.ENABLE = 1;
+  while (DAC->SYNCBUSY.bit.ENABLE)
+    ;
+  while (!DAC->STATUS.bit.READY0)
+    ;
+#elif DAC_MAX == DAC_TOP
+  DAC->CTRLB.bit.REFSEL = 0; // VMAX = 1.0V
+  while (DAC->STATUS.bit.SYNCBUSY)
+    ;
+#endif
+
+  // DMA descriptor list & job -------------------------------------------
+
+  buildDescriptors();
+
+  // The DMA library needs to think it's allocated at least one valid
+  // descriptor, so we do that here (it's overwritten below). Only the
+  // first time though; the library remembers across free() & allocate().
+  if (!primed) {
+    (void)dma.addDescriptor(NULL, NULL, 42, DMA_BEAT_SIZE_BYTE, false, false);
+    primed = true;
+  }
+
+  // Each channel's first descriptor lives in the base table shared by
+  // all channels (set up by Adafruit_ZeroDMA). Rather than moving the
+  // base address to our list, which would break any other DMA channels,
+  // a copy of our first descriptor (odd field vsync) goes in this
+  // channel's slot. It links on into our list, which thereafter loops
+  // back to the original.
+  memcpy((void *)baseDescriptor(), (const void *)descriptor,
+         sizeof(DmacDescriptor));
+
+  if (packedSize) {
+    clear(); // Initialize frame buffer(s)
+    if (packedBuffer != packedFront)
+      memcpy(packedFront, packedBuffer, packedSize);
+    initRow(&frameBuffer[0]); // Sync & blank parts of line buffers, then
+    initRow(&frameBuffer[videoSpec[mode].rowPixelClocks]); // first lines
+    endOfField(2);
+  } else {
+    // Whole rows, sync included, just this once; after this, clear() and
+    // drawing only ever write the visible span.
+    for (int16_t y = 0; y < HEIGHT; y++)
+      initRow(&frameBuffer[y * videoSpec[mode].rowPixelClocks]);
+    if (frameBuffer != frontBuffer)
+      memcpy(frontBuffer, frameBuffer, sizeof(uint16_t) * bufferSize);
+  }
+
+  return (dma.startJob() == DMA_STATUS_OK);
+}
+
+// Fill DMA descriptor table (layout is explained in begin())
+void Adafruit_CompositeVideo::buildDescriptors(void) {
+  boolean packed = flags & LINEBUFFER_FLAGS;
+  boolean compact = packed || (flags & COMPOSITE_COMPACT);
+  uint16_t lines = packed ? 2 : videoSpec[mode].scanlines;
+  uint16_t evenSync = compact ? 1 : lines + 2;
   DmacDescriptor *desc;
 
-  for (uint16_t i = 0; i < videoSpec[mode].numDescriptors; i++) {
+  for (uint16_t i = 0; i < numDescriptors; i++) {
     desc = &descriptor[i];
     desc->BTCTRL.bit.VALID = true;
     desc->BTCTRL.bit.EVOSEL = DMA_EVENT_OUTPUT_DISABLE;
@@ -322,84 +845,1342 @@ boolean Adafruit_NTSC40x24::begin(void) {
     desc->BTCTRL.bit.DSTINC = false;
     desc->BTCTRL.bit.STEPSEL = DMA_STEPSEL_DST;
     desc->BTCTRL.bit.STEPSIZE = DMA_ADDRESS_INCREMENT_STEP_SIZE_1;
-    desc->DSTADDR.reg = (uint32_t)&DAC->DATA.reg;
-    desc->DESCADDR.reg = (uint32_t)&descriptor[i + 1];
-
-    if (i == 0) {
-      // Descriptor 0 is the odd field vertical sync
-      desc->SRCADDR.reg = (uint32_t)NTSC40x24vsyncOdd;
-      desc->BTCNT.reg =
-          sizeof(NTSC40x24vsyncOdd) / sizeof(NTSC40x24vsyncOdd[0]);
-    } else if (i <= 216) {
-      // Descriptors 1-216 are pixel data
-      uint8_t row = (i - 1) / 9; // 0 to 23
-      desc->SRCADDR.reg =
-          (uint32_t)&frameBuffer[row * videoSpec[mode].rowPixelClocks];
-      desc->BTCNT.reg = videoSpec[mode].rowPixelClocks;
-    } else if (i == 217) {
-      // Descriptor 217 is vsync hack (will go away later)
+#if defined(__SAMD51__)
+    desc->DSTADDR.reg = COMPOSITE_DMA_ADDR(&DAC->DATA[0].reg); // DAC0 = A0
+#else
+    desc->DSTADDR.reg = COMPOSITE_DMA_ADDR(&DAC->DATA.reg);
+#endif
+    desc->DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[i + 1]);
+
+    if ((i == 0) || (i == evenSync)) {
+      // Odd or even field vertical sync
+      uint8_t f = (i > 0);
+      desc->SRCADDR.reg = COMPOSITE_DMA_ADDR(videoSpec[mode].vsync[f]);
+      desc->BTCNT.reg = videoSpec[mode].vsyncLen[f];
+      if (compact && !f) // Skip over even vsync, straight to pixel data
+        desc->DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[2]);
+    } else if ((!compact && (i == lines + 1)) || (i == numDescriptors - 1)) {
+      // End-of-field descriptors set vBlank and raise the interrupt
+      // for waitForVBlank() and onVBlank(). In compact mode there's
+      // only one; the first field to end is odd, followed by even.
+      desc->BTCTRL.bit.BLOCKACT = DMA_BLOCK_ACTION_INT;
       desc->BTCTRL.bit.BEATSIZE = DMA_BEAT_SIZE_BYTE;
       desc->BTCTRL.bit.SRCINC = false;
-      desc->SRCADDR.reg = (uint32_t)&vBlank1;
+      desc->SRCADDR.reg = COMPOSITE_DMA_ADDR(
+          (compact || (i == lines + 1)) ? &vBlank1 : &vBlank2);
       desc->BTCNT.reg = 1;
-      desc->DSTADDR.reg = (uint32_t)&vBlank;
-    } else if (i == 218) {
-      // Descriptor 218 is the even field vertical sync
-      desc->SRCADDR.reg = (uint32_t)NTSC40x24vsyncEven;
-      desc->BTCNT.reg =
-          sizeof(NTSC40x24vsyncEven) / sizeof(NTSC40x24vsyncEven[0]);
-    } else if (i <= 434) {
-      // Descriptors 219-434 are pixel data
-      uint8_t row = (i - 219) / 9; // 0 to 23
-      desc->SRCADDR.reg =
-          (uint32_t)&frameBuffer[row * videoSpec[mode].rowPixelClocks];
-      desc->BTCNT.reg = videoSpec[mode].rowPixelClocks;
+      desc->DSTADDR.reg = COMPOSITE_DMA_ADDR(&fieldEnd);
+      if (compact)
+        desc->DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[1]);
     } else {
-      // Last descriptor (435) is vsync hack (also going away later)
-      desc->BTCTRL.bit.BEATSIZE = DMA_BEAT_SIZE_BYTE;
-      desc->BTCTRL.bit.SRCINC = false;
-      desc->SRCADDR.reg = (uint32_t)&vBlank2;
-      desc->BTCNT.reg = 1;
-      desc->DSTADDR.reg = (uint32_t)&vBlank;
+      // Everything else is pixel data, address is set below
+      desc->BTCNT.reg = videoSpec[mode].rowPixelClocks;
+      desc->SRCADDR.reg = 0;
+      // Packed modes refill each line buffer as soon as it's been output
+      if (packed)
+        desc->BTCTRL.bit.BLOCKACT = DMA_BLOCK_ACTION_INT;
     }
     if (desc->BTCTRL.bit.SRCINC)
       desc->SRCADDR.reg += 2 * desc->BTCNT.reg;
   }
+  if (packed) {
+    // Line buffers A & B, looping until the interrupt handler diverts
+    // the last line to the end-of-field descriptor.
+    uint8_t rpc = videoSpec[mode].rowPixelClocks;
+    descriptor[2].SRCADDR.reg = COMPOSITE_DMA_ADDR(&frontBuffer[rpc]);
+    descriptor[3].SRCADDR.reg = COMPOSITE_DMA_ADDR(&frontBuffer[rpc * 2]);
+    descriptor[3].DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[2]);
+  } else {
+    pointDescriptors(frontBuffer);
+  }
 
   // Link last DMA descriptor back to first.  Once the transfer job is
   // started, video generation runs entirely on its own with *zero* CPU
   // intervention!  Interrupts, NeoPixels, all of that runs without harm.
-  descriptor[videoSpec[mode].numDescriptors - 1].DESCADDR.reg =
-      (uint32_t)&descriptor[0];
+  // (Except in compact mode, which needs the end-of-field interrupt.)
+  if (!compact)
+    descriptor[numDescriptors - 1].DESCADDR.reg =
+        COMPOSITE_DMA_ADDR(&descriptor[0]);
+
+#if COMPOSITE_VSYNC_RAM
+  if (vsyncPool) { // Replace vsync descriptors with chains through RAM
+    uint16_t n = chainVsync(0, &descriptor[0], vsyncChain);
+    chainVsync(1, &descriptor[evenSync], &vsyncChain[n - 1]);
+  }
+#endif
+}
+
+#if COMPOSITE_VSYNC_RAM
+// Build halfline[] list for both fields' vsync tables, in the order they
+// first appear (so e.g. the two halves of a blank line are adjacent).
+// Returns the number found, or 0 if there are too many to bother.
+uint8_t Adafruit_CompositeVideo::findHalflines(void) {
+  uint8_t hl = videoSpec[mode].rowPixelClocks / 2;
+  numHalflines = 0;
+  for (uint8_t f = 0; f < 2; f++) {
+    for (uint16_t i = 0; i < videoSpec[mode].vsyncLen[f]; i += hl) {
+      if (findHalfline(&videoSpec[mode].vsync[f][i], hl) >= MAX_HALFLINES)
+        return numHalflines = 0;
+    }
+  }
+  return numHalflines;
+}
+
+// Express one field's vsync table as a chain of descriptors through the
+// RAM halflines. Each descriptor covers as many consecutive halflines of
+// the table as are also consecutive in RAM (e.g. a whole blank line).
+// The first goes in 'head' (the usual vsync descriptor, whose settings
+// the rest copy), the others in 'chain', and the last links on to where
+// head did. With NULL head, descriptors are just counted. Returns count.
+uint16_t Adafruit_CompositeVideo::chainVsync(uint8_t f, DmacDescriptor *head,
+                                            DmacDescriptor *chain) {
+  uint8_t hl = videoSpec[mode].rowPixelClocks / 2;
+  const uint16_t *table = videoSpec[mode].vsync[f];
+  uint16_t halves = videoSpec[mode].vsyncLen[f] / hl, count = 0;
+  uint32_t next = head ? head->DESCADDR.reg : 0;
+  DmacDescriptor *desc = head;
+  for (uint16_t p = 0; p < halves; count++) {
+    uint8_t k = findHalfline(&table[p * hl], hl), run = 1;
+    while (((p + run) < halves) && ((k + run) < numHalflines) &&
+           !memcmp(halfline[k + run], &table[(p + run) * hl],
+                   hl * sizeof(uint16_t)))
+      run++;
+    if (head) {
+      if (count) {
+        desc->DESCADDR.reg = COMPOSITE_DMA_ADDR(chain);
+        desc = chain++;
+        desc->BTCTRL.reg = head->BTCTRL.reg;
+        desc->DSTADDR.reg = head->DSTADDR.reg;
+      }
+      desc->BTCNT.reg = run * hl;
+      desc->SRCADDR.reg = COMPOSITE_DMA_ADDR(&vsyncPool[(k + run) * hl]);
+    }
+    p += run;
+  }
+  if (head)
+    desc->DESCADDR.reg = next;
+  return count;
+}
+#endif // COMPOSITE_VSYNC_RAM
+
+// Point each field's pixel data descriptors at rows of a framebuffer.
+// Scanlines are divided evenly among framebuffer rows, e.g. 9 lines per
+// row for 24 rows, or alternately 5 and 4 lines per row for 48. Rows
+// are offset by the vertical scroll position, wrapping around, unless a
+// raster program picks the row for each line.
+void Adafruit_CompositeVideo::pointDescriptors(uint16_t *buf) {
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  uint16_t lines = videoSpec[mode].scanlines;
+  boolean compact = flags & COMPOSITE_COMPACT;
+  for (uint16_t i = 0; i < lines; i++) {
+    // Compact layout has one set of descriptors for both fields
+    for (uint8_t f = 0; f < (compact ? 1 : 2); f++) {
+      int16_t row = raster ? raster[i].row : scanlineRow(i, f);
+      // SRCADDR is the END of the transfer (see above), hence row + 1.
+      // Rows outside the framebuffer show the blank line that starts the
+      // odd field vsync table (in flash, which the DMA can read directly).
+      uint32_t addr = COMPOSITE_DMA_ADDR(((row < 0) || (row >= HEIGHT))
+                                             ? &videoSpec[mode].vsync[0][rpc]
+                                             : &buf[(row + 1) * rpc]);
+      if (compact)
+        descriptor[2 + i].SRCADDR.reg = addr;
+      else if (!f)
+        descriptor[1 + i].SRCADDR.reg = addr; // Odd field
+      else
+        descriptor[lines + 3 + i].SRCADDR.reg = addr; // Even field
+    }
+  }
+}
+
+// Framebuffer row shown on scanline 'line' of a field (0 = odd, 1 = even)
+// when no raster program is set, including the vertical scroll offset.
+// With COMPOSITE_INTERLACE, each even field line is positioned between
+// two odd field lines, so rows are divided over both fields' lines
+// together (e.g. 40x48 rows are then exactly 9 lines of the 432-line
+// frame, rather than alternately 5 and 4 lines of each field). After
+// setRowHeight(), rows are a fixed number of lines each instead, and
+// lines above or below the framebuffer are blank (-1).
+int16_t Adafruit_CompositeVideo::scanlineRow(uint16_t line, uint8_t field) {
+  uint16_t row;
+  if (rowLines) {
+    int16_t n = line - rowTop;
+    if ((n < 0) || (n >= rowLines * HEIGHT))
+      return -1;
+    row = n / rowLines;
+  } else {
+    uint16_t lines = videoSpec[mode].scanlines;
+    row = (flags & COMPOSITE_INTERLACE)
+              ? (2UL * line + field) * HEIGHT / (2 * lines)
+              : (uint32_t)line * HEIGHT / lines;
+  }
+  row += viewY;
+  return (row >= HEIGHT) ? row - HEIGHT : row;
+}
+
+// Called from the DMA interrupt at the end of each field
+void Adafruit_CompositeVideo::endOfField(uint8_t field) {
+  boolean packed = flags & LINEBUFFER_FLAGS;
+  if (packed || (flags & COMPOSITE_COMPACT)) {
+    // The DMA has already moved on to the next field's vsync descriptor
+    // by now; re-link the shared end-of-field descriptor so the field
+    // after THAT has the opposite parity. If interrupts are held off
+    // for an entire field, the image is still stable, just not
+    // interlaced for a moment.
+    DmacDescriptor *desc = &descriptor[numDescriptors - 1];
+    if (field == 1) { // Odd field just ended, even is now in progress
+      desc->SRCADDR.reg = COMPOSITE_DMA_ADDR(&vBlank2);
+      desc->DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[0]);
+    } else {
+      desc->SRCADDR.reg = COMPOSITE_DMA_ADDR(&vBlank1);
+      desc->DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[1]);
+    }
+  }
+  boolean repoint = false; // 16-bit pixel descriptors, see below
+  if (swapPending && !packed) {
+    // Swap 16-bit buffers if requested (see swapBuffers())
+    uint16_t *b = frameBuffer;
+    frameBuffer = frontBuffer;
+    frontBuffer = b;
+    if (swapCopy)
+      memcpy(frameBuffer, frontBuffer,
+             sizeof(uint16_t) * videoSpec[mode].rowPixelClocks * HEIGHT);
+    swapPending = swapCopy = false;
+    repoint = true;
+  }
+  if (scrollPending) {
+    // New scroll position or raster program takes effect with the next
+    // field. The DMA is in vertical sync now and won't fetch a pixel
+    // descriptor for a millisecond or so, plenty of time to re-point
+    // them all (or, for a new front buffer, too).
+    viewX = scrollX;
+    viewY = scrollY;
+    raster = rasterNext;
+    rowLines = rowLinesNext;
+    rowTop = rowTopNext;
+    scrollPending = false;
+    if (!packed)
+      repoint = true;
+  }
+  if (repoint)
+    pointDescriptors(frontBuffer);
+  if (packed) {
+    lineField = (field == 1); // Field to come is the opposite one
+    // Swap packed buffers if requested; it's safe now, nothing's been
+    // expanded from the front buffer yet for the field that follows.
+    if (swapPending) {
+      uint8_t *b = packedBuffer;
+      packedBuffer = packedFront;
+      packedFront = b;
+      if (swapCopy) // Requested from an interrupt, see swapBuffers()
+        memcpy(packedBuffer, packedFront, packedBytes());
+      swapPending = swapCopy = false;
+    }
+    if (spritePending) {
+      memcpy(sprite, spriteNext, sizeof sprite);
+      spritePending = false;
+    }
+    // Restart the line buffer loop and prefill the first two lines,
+    // there's the whole vertical sync period to do this.
+    descriptor[2].DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[3]);
+    descriptor[3].DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[2]);
+    scanline = 0;
+    lineRow[0] = lineRow[1] = -2; // (-1 is a blank line, -2 = nothing)
+    expandLine(0, 0);
+    expandLine(1, 1);
+  }
+}
+
+// Called from the DMA interrupt at the end of each scanline in packed
+// modes. Scanline n has just finished (from line buffer n & 1) and the
+// DMA is outputting line n+1 from the other buffer, so the finished one
+// is refilled with line n+2. The deadline for that is one scanline away
+// (~63 uS); if interrupts are held off longer than that, the image may
+// glitch or roll momentarily (it recovers at the next field).
+void Adafruit_CompositeVideo::endOfLine(void) {
+  uint16_t n = scanline++;
+  uint16_t next = n + 2;
+  uint8_t b = n & 1;
+  if (next < videoSpec[mode].scanlines) {
+    if (next == videoSpec[mode].scanlines - 1) // Last line, then vblank
+      descriptor[2 + b].DESCADDR.reg = COMPOSITE_DMA_ADDR(&descriptor[4]);
+    expandLine(b, next);
+  }
+}
+
+// Convert one row of the packed front buffer into DAC values in a line
+// buffer. Rows span several scanlines, and alternate scanlines use
+// alternate buffers, so most of the time that buffer already holds the
+// right row and nothing needs doing. Scrolling offsets the row selected
+// and the column each line starts from, wrapping around. A raster program
+// instead sets the row, column and brightness of every line.
+void Adafruit_CompositeVideo::expandLine(uint8_t buf, uint16_t line) {
+  int16_t row, sx = viewX;
+  uint16_t mul = 256; // Brightness multiplier, 256 = unchanged
+  if (raster) {
+    // No skipping repeated rows, as pan or brightness may differ
+    const CompositeRasterLine *r = &raster[line];
+    row = r->row;
+    sx = r->scrollX % WIDTH;
+    if (sx < 0)
+      sx += WIDTH;
+    mul = r->brightness + 1;
+    lineRow[buf] = -2;
+  } else {
+    row = scanlineRow(line, lineField);
+    if (lineRow[buf] == row)
+      return;
+    lineRow[buf] = row;
+  }
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  uint16_t *dst = &frontBuffer[buf * rpc + videoSpec[mode].xOffset];
+  if ((row < 0) || (row >= HEIGHT)) {
+    // Blank line (raster program row -1, or outside setRowHeight() rows):
+    // blanking level, exactly as the 16-bit modes' blank line in flash
+    for (int16_t x = 0; x < WIDTH; x++)
+      dst[x] = N_;
+  } else if (flags & COMPOSITE_PACKED4) {
+    const uint8_t *src = &packedFront[row * ((WIDTH + 1) / 2)];
+    const uint16_t *lut = nibbleLUT;
+    uint16_t dim[16];
+    if (mul < 256) {
+      for (uint8_t i = 0; i < 16; i++)
+        dim[i] = grayLUT[i * 17 * mul >> 8];
+      lut = dim;
+    }
+    if (!sx) { // Unscrolled, two pixels per byte
+      for (int16_t x = 0; x < WIDTH; x += 2) {
+        uint8_t p = *src++;
+        dst[x] = lut[p >> 4];
+        dst[x + 1] = lut[p & 15]; // (If odd width, lands on blank px)
+      }
+      if (WIDTH & 1)
+        dst[WIDTH] = N_;
+    } else {
+      int16_t v = sx;
+      for (int16_t x = 0; x < WIDTH; x++) {
+        uint8_t p = src[v / 2];
+        dst[x] = lut[(v & 1) ? (p & 15) : (p >> 4)];
+        if (++v == WIDTH)
+          v = 0;
+      }
+    }
+  } else if (flags & COMPOSITE_TEXT) {
+    // Each cell is the 5 font columns (LSB = top row) plus a blank column.
+    // Pixels right of the last whole cell, or below the last whole row of
+    // cells, show as background.
+    uint16_t fg = grayLUT[(textcolor & 0xFF) * mul >> 8];
+    uint16_t bg = (textbgcolor == textcolor)
+                      ? grayLUT[0]
+                      : grayLUT[(textbgcolor & 0xFF) * mul >> 8];
+    uint8_t cols = textColumns(), bit = 1 << (row & 7);
+    const uint8_t *cells =
+        (row / 8 < textRows()) ? &packedFront[row / 8 * cols] : NULL;
+    int16_t v = sx;               // Virtual pixel column,
+    uint8_t c = v / 6, i = v % 6; // its cell & column within cell
+    for (int16_t x = 0; x < WIDTH; x++) {
+      dst[x] = (cells && (c < cols) && (i < 5) &&
+                (pgm_read_byte(&font[cells[c] * 5 + i]) & bit))
+                   ? fg
+                   : bg;
+      if (++i == 6) {
+        i = 0;
+        c++;
+      }
+      if (++v == WIDTH)
+        v = c = i = 0;
+    }
+  } else {
+    // Multiplying by 256 and shifting is a no-op, one cycle each on M0
+    const uint8_t *src = &packedFront[row * WIDTH];
+    int16_t n = WIDTH - sx, x;
+    for (x = 0; x < n; x++)
+      dst[x] = grayLUT[src[sx + x] * mul >> 8];
+    for (; x < WIDTH; x++) // Wrapped-around part, if scrolled
+      dst[x] = grayLUT[src[x - n] * mul >> 8];
+  }
+  if ((row >= 0) && (row < HEIGHT)) {
+    // Screen row, i.e. before scrolling, unless set by a raster program
+    int16_t r = raster ? row : row - viewY;
+    overlaySprites(dst, (r < 0) ? r + HEIGHT : r, mul);
+  }
+  if (emphasis)
+    emphasize(dst, WIDTH, dst[-1]);
+}
+
+// Sprites go over the expanded line, so the framebuffer never changes.
+// Each line crosses at most one row of each sprite. The sprite table is
+// only replaced at the end of a field, so rows cached in the line
+// buffers (see expandLine()) stay valid until then.
+void Adafruit_CompositeVideo::overlaySprites(uint16_t *dst, int16_t row,
+                                             uint16_t mul) {
+  for (uint8_t n = 0; n < COMPOSITE_SPRITES; n++) {
+    const CompositeSprite *s = &sprite[n];
+    int16_t r = row - s->y;
+    if (!s->bitmap || (r < 0) || (r > 7))
+      continue;
+    const uint8_t *src = &s->bitmap[r * 8];
+    uint8_t m = s->mask ? s->mask[r] : 0xFF;
+    for (int16_t x = s->x; m; x++, src++, m <<= 1) {
+      if ((m & 0x80) && (x >= 0) && (x < WIDTH))
+        dst[x] = grayLUT[*src * mul >> 8];
+    }
+  }
+}
 
-  // The DMA library needs to think it's allocated at least one
-  // valid descriptor, so we do that here (though it's never used)
-  (void)dma.addDescriptor(NULL, NULL, 42, DMA_BEAT_SIZE_BYTE, false, false);
+boolean Adafruit_CompositeVideo::setSprite(uint8_t n, int16_t x, int16_t y,
+                                           const uint8_t *bitmap,
+                                           const uint8_t *mask) {
+  if ((n >= COMPOSITE_SPRITES) || !packedBuffer)
+    return false; // 16-bit modes have no line expansion to draw into
+  __disable_irq(); // Not copied half-changed at end of field
+  CompositeSprite *s = &spriteNext[n];
+  s->bitmap = bitmap;
+  s->mask = mask;
+  s->x = x;
+  s->y = y;
+  spritePending = true;
+  __enable_irq();
+  return true;
+}
 
-  // Point DMA descriptor base address to our descriptor list
+boolean Adafruit_CompositeVideo::moveSprite(uint8_t n, int16_t x,
+                                            int16_t y) {
+  if ((n >= COMPOSITE_SPRITES) || !packedBuffer)
+    return false;
   __disable_irq();
-  __DMB();
-  DMAC->CTRL.reg = 0; // Disable DMA controller
-  DMAC->BASEADDR.bit.BASEADDR = (uint32_t)descriptor;
-  DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
-  __DMB();
+  spriteNext[n].x = x;
+  spriteNext[n].y = y;
+  spritePending = true;
   __enable_irq();
+  return true;
+}
 
-  clear(); // Initialize frame buffer
+// DAC pre-emphasis. The DAC takes longer to settle on big steps than
+// small ones, so at fast pixel clocks edges are smeared into the next
+// pixel or two. Overshooting each change in level by a fraction of the
+// step gets the output there sooner; the following pixel, if the same
+// level, then brings it back. Levels are limited to between blanking
+// (so it can't be mistaken for sync) and a little above white. Only
+// applied to whole lines as they're expanded (packed and text modes):
+// a 16-bit framebuffer would hold already-boosted neighbors, making the
+// result depend on drawing order.
+void Adafruit_CompositeVideo::emphasize(uint16_t *dst, int16_t n,
+                                        uint16_t prev) {
+  int16_t lo = N_, hi = whiteLevel + (whiteLevel - blackLevel) / 4;
+  if (hi > DAC_TOP)
+    hi = DAC_TOP;
+  for (int16_t i = 0; i < n; i++) {
+    int16_t v = dst[i];
+    int16_t out = v + (v - (int16_t)prev) * emphasis / 16;
+    prev = v;
+    dst[i] = (out < lo) ? lo : (out > hi) ? hi : out;
+  }
+}
 
-  return (dma.startJob() == DMA_STATUS_OK);
+boolean Adafruit_CompositeVideo::setPreEmphasis(uint8_t amount) {
+  if (!packedBuffer)
+    return false; // Not running, or 16-bit (no line expansion to apply it)
+  emphasis = (amount > 16) ? 16 : amount;
+  return true;
+}
+
+// BRIGHTNESS CALIBRATION --------------------------------------------------
+// Black and white levels and gamma are shared by all objects (there's
+// one DAC, and one monitor on it). Only picture levels change; sync and
+// blanking, all that the vsync tables and row prefixes hold, stay put.
+
+boolean Adafruit_CompositeVideo::setLevels(uint16_t black, uint16_t white) {
+  if ((black < N_) || (white <= black) || (white > DAC_TOP))
+    return false;
+  uint16_t b = blackLevel, w = whiteLevel;
+  blackLevel = black;
+  whiteLevel = white;
+  if (rebuildLUT())
+    return true;
+  blackLevel = b; // Out of memory, no change
+  whiteLevel = w;
+  return false;
+}
+
+boolean Adafruit_CompositeVideo::setGamma(float gamma) {
+  if (!(gamma > 0.0))
+    return false;
+  float g = gammaValue;
+  gammaValue = gamma;
+  if (rebuildLUT())
+    return true;
+  gammaValue = g;
+  return false;
+}
+
+// A new table is built before the old one is freed, because converting
+// pixels already in a 16-bit framebuffer means finding each one's gray
+// level in the old table. At the default levels and gamma, it's back to
+// the tables in flash; at gamma 1.0 the same integer formula is used.
+boolean Adafruit_CompositeVideo::rebuildLUT(void) {
+  const uint16_t *old = grayLUT, *gray = defaultGrayLUT;
+  const uint16_t *nibble = defaultNibbleLUT;
+  if ((blackLevel != NK) || (whiteLevel != NW) || (gammaValue != 1.0f)) {
+    uint16_t *lut = (uint16_t *)malloc((256 + 16) * sizeof(uint16_t));
+    if (!lut)
+      return false;
+    uint16_t range = whiteLevel - blackLevel;
+    for (uint16_t i = 0; i < 256; i++)
+      lut[i] = blackLevel +
+               ((gammaValue == 1.0f)
+                    ? i * range / 255 // As G2D()
+                    : (uint16_t)(powf(i / 255.0f, gammaValue) * range + 0.5f));
+    for (uint8_t i = 0; i < 16; i++)
+      lut[256 + i] = lut[i * 17];
+    gray = lut;
+    nibble = &lut[256];
+  }
+  if (gray == old)
+    return true; // Defaults already
+
+  // Only the running display has framebuffers (end() frees them), so
+  // that's the one to convert, whichever object this was called on
+  if (activeVideo)
+    activeVideo->convertLevels(old, gray);
+
+  // Packed and text modes pick up the new table from the next line on
+  __disable_irq();
+  grayLUT = gray;
+  nibbleLUT = nibble;
+  __enable_irq();
+  if (old != defaultGrayLUT)
+    free((void *)old);
+  return true;
+}
+
+// Convert 16-bit framebuffer(s) from one brightness table to another. The
+// tables are in ascending order, so finding each pixel's gray level in
+// the old one is a binary search, no floating point per pixel. Where the
+// old table repeats a value (e.g. dark grays at a high gamma), the lowest
+// of those grays is the one that comes back.
+void Adafruit_CompositeVideo::convertLevels(const uint16_t *from,
+                                            const uint16_t *to) {
+  if (!frameBuffer || packedBuffer)
+    return; // Not running, or packed pixels (which keep gray values)
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  for (uint8_t b = 0; b < ((frameBuffer == frontBuffer) ? 1 : 2); b++) {
+    uint16_t *row = &(b ? frontBuffer : frameBuffer)[videoSpec[mode].xOffset];
+    for (int16_t y = 0; y < HEIGHT; y++, row += rpc) {
+      for (int16_t x = 0; x < WIDTH; x++) {
+        uint16_t v = row[x];
+        uint8_t lo = 0, hi = 255; // Find nearest from[] entry to v
+        while (lo < hi) {
+          uint8_t mid = (lo + hi) / 2;
+          if (from[mid] < v)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+        if (lo && ((v - from[lo - 1]) < (from[lo] - v)))
+          lo--;
+        row[x] = to[lo];
+      }
+    }
+  }
+}
+
+// Size of one packed framebuffer (or text cell array) in bytes, or 0 if
+// the mode uses full 16-bit framebuffers.
+uint32_t Adafruit_CompositeVideo::packedBytes(void) const {
+  if (flags & COMPOSITE_PACKED4)
+    return (WIDTH + 1) / 2 * HEIGHT;
+  if (flags & COMPOSITE_PACKED8)
+    return WIDTH * HEIGHT;
+  if (flags & COMPOSITE_TEXT)
+    return textColumns() * textRows();
+  return 0;
+}
+
+// This channel's entry in the DMA controller's shared descriptor table
+DmacDescriptor *Adafruit_CompositeVideo::baseDescriptor(void) {
+  return &((DmacDescriptor *)COMPOSITE_DMA_PTR(
+      DMAC->BASEADDR.reg))[dma.getChannel()];
+}
+
+// Undo everything begin() did, in reverse order
+void Adafruit_CompositeVideo::end(void) {
+  if (!descriptor)
+    return;
+
+  dma.abort();
+  // Don't leave the channel's base descriptor linking into our list
+  memset((void *)baseDescriptor(), 0, sizeof(DmacDescriptor));
+  (void)dma.free();
+  activeVideo = NULL;
+  fieldEnd = 0;
+
+  analogWrite(A0, 0); // DAC stays enabled but idle, no more signal
+
+  stopTimer();
+  // And its clock. The generic clock channel is shared with the timer's
+  // partner (see COMPOSITE_TC3 etc.); a sketch using that one too should
+  // set it up again after end().
+  uint8_t id = timerSpec[timer].clockID;
+#if defined(__SAMD51__)
+  GCLK->PCHCTRL[id].bit.CHEN = 0;
+  while (GCLK->PCHCTRL[id].bit.CHEN)
+    ;
+  *timerSpec[timer].apbMask &= ~timerSpec[timer].apbBit; // Bus clock off
+#else
+  GCLK->CLKCTRL.reg = (uint16_t)GCLK_CLKCTRL_ID(id); // CLKEN clear
+  while (GCLK->STATUS.bit.SYNCBUSY == 1)
+    ;
+#endif
+
+  free(descriptor);
+  descriptor = NULL;
+  numDescriptors = 0;
+  allocated = 0;
+  frameBuffer = frontBuffer = NULL;
+  packedBuffer = packedFront = NULL;
+  swapPending = swapCopy = false;
+  vsyncChain = NULL; // (In the freed block)
+  vsyncPool = NULL;
+  vsyncDescs = 0;
+
+  // Scrolling, raster program, row height, sprites and pre-emphasis are
+  // per session, the next begin() starts over without them. A raster
+  // program passed in is the sketch's to free once end() returns.
+  scrollX = scrollY = viewX = viewY = 0;
+  raster = rasterNext = NULL;
+  rowLines = rowTop = rowLinesNext = rowTopNext = 0;
+  scrollPending = false;
+  memset(sprite, 0, sizeof sprite);
+  memset(spriteNext, 0, sizeof spriteNext);
+  spritePending = false;
+  emphasis = 0;
+}
+
+// Set n DAC samples to one level, two per 32-bit store. Buffers are
+// word-aligned, but xOffset and row lengths can be odd, so either end may
+// need a single 16-bit store.
+typedef uint32_t __attribute__((__may_alias__)) dacPair;
+static void fillLevel(uint16_t *dst, int16_t n, uint16_t level) {
+  if (n <= 0)
+    return;
+  if ((uintptr_t)dst & 2) {
+    *dst++ = level;
+    n--;
+  }
+  dacPair pair = level * 0x00010001UL, *d = (dacPair *)dst;
+  for (int16_t i = n / 2; i > 0; i--)
+    *d++ = pair;
+  if (n & 1)
+    *(uint16_t *)d = level;
+}
+
+boolean Adafruit_CompositeVideo::setTimer(uint8_t timer, uint8_t generator,
+                                          uint32_t hz) {
+  if (descriptor || (timer > COMPOSITE_TCC2) ||
+      (generator >= GCLK_GEN_NUM) || !hz)
+    return false; // Running (can't switch mid-stream) or out of range
+  if (!timerSpec[timer].tc && !timerSpec[timer].tcc)
+    return false; // Not on this part
+  this->timer = timer;
+  clockGen = generator;
+  clockHz = hz;
+  return true;
 }
 
-void Adafruit_NTSC40x24::clear(void) {
-  const uint16_t emptyLine[] = {NTSC_EMPTY_LINE50};
-  for (uint8_t i = 0; i < 24; i++) {
-    memcpy(&frameBuffer[i * videoSpec[mode].rowPixelClocks], &emptyLine,
-           sizeof(emptyLine));
+// TIMER -------------------------------------------------------------------
+// The timer's only job is a DMA trigger at each overflow, once per pixel
+// clock; no output pins or interrupts are involved. Default is TC5 (TC3
+// on SAMD51 parts without it), which will knock out the Tone library.
+
+void Adafruit_CompositeVideo::startTimer(uint32_t period) {
+  uint8_t id = timerSpec[timer].clockID;
+#if defined(__SAMD51__)
+  *timerSpec[timer].apbMask |= timerSpec[timer].apbBit; // Bus clock on
+  GCLK->PCHCTRL[id].bit.CHEN = 0; // Channel must be off to change source
+  while (GCLK->PCHCTRL[id].bit.CHEN)
+    ;
+  GCLK->PCHCTRL[id].reg = GCLK_PCHCTRL_GEN(clockGen) | GCLK_PCHCTRL_CHEN;
+  while (!GCLK->PCHCTRL[id].bit.CHEN)
+    ;
+#else
+  GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN |
+                                 GCLK_CLKCTRL_GEN(clockGen) |
+                                 GCLK_CLKCTRL_ID(id));
+  while (GCLK->STATUS.bit.SYNCBUSY == 1)
+    ;
+#endif
+
+  stopTimer(); // Disable timer to config it
+
+  Tc *tc = timerSpec[timer].tc;
+  if (tc) {
+#if defined(__SAMD51__)
+    tc->COUNT16.CTRLA.reg =      // Configure timer counter
+        TC_CTRLA_MODE_COUNT16 |  // 16-bit counter mode
+        TC_CTRLA_PRESCALER_DIV1; // 1:1 Prescale
+    tc->COUNT16.WAVE.reg = TC_WAVE_WAVEGEN_MFRQ; // Match Frequency mode
+#else
+    tc->COUNT16.CTRLA.reg =      // Configure timer counter
+        TC_CTRLA_MODE_COUNT16 |  // 16-bit counter mode
+        TC_CTRLA_WAVEGEN_MFRQ |  // Match Frequency mode
+        TC_CTRLA_PRESCALER_DIV1; // 1:1 Prescale
+#endif
+    tcSync(tc);
+    tc->COUNT16.CC[0].reg = period;
+    tcSync(tc);
+    tc->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE; // Re-enable
+    tcSync(tc);
+  } else {
+    Tcc *tcc = timerSpec[timer].tcc;
+    tcc->CTRLA.reg = TCC_CTRLA_PRESCALER_DIV1; // 1:1 Prescale
+    tcc->WAVE.reg = TCC_WAVE_WAVEGEN_NFRQ;     // Normal freq: count to PER
+    while (tcc->SYNCBUSY.reg)
+      ;
+    tcc->PER.reg = period;
+    while (tcc->SYNCBUSY.reg)
+      ;
+    tcc->CTRLA.reg |= TCC_CTRLA_ENABLE; // Re-enable
+    while (tcc->SYNCBUSY.reg)
+      ;
+  }
+}
+
+void Adafruit_CompositeVideo::stopTimer(void) {
+  Tc *tc = timerSpec[timer].tc;
+  if (tc) {
+    tc->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+    tcSync(tc);
+  } else {
+    Tcc *tcc = timerSpec[timer].tcc;
+    tcc->CTRLA.reg &= ~TCC_CTRLA_ENABLE;
+    while (tcc->SYNCBUSY.reg)
+      ;
   }
 }
 
-// Hacky stuff, don't use this
-void Adafruit_NTSC40x24::setBlank(uint8_t value) { vBlank = value; }
+// Framebuffer rows are a blank line (the first line of the odd field
+// vsync table, in flash) with the visible span set to black.
+void Adafruit_CompositeVideo::initRow(uint16_t *row) {
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  memcpy(row, videoSpec[mode].vsync[0], rpc * sizeof(uint16_t));
+  fillLevel(&row[videoSpec[mode].xOffset], WIDTH, grayLUT[0]);
+}
+
+// The sync and blanking parts of each row are set up once by begin() and
+// nothing draws outside the visible span, so only that is refilled here.
+void Adafruit_CompositeVideo::clear(void) {
+  if (packedBuffer) {
+    memset(packedBuffer, (flags & COMPOSITE_TEXT) ? ' ' : 0, packedBytes());
+    return;
+  }
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  uint16_t *row = &frameBuffer[videoSpec[mode].xOffset];
+  for (int16_t y = 0; y < HEIGHT; y++, row += rpc)
+    fillLevel(row, WIDTH, grayLUT[0]);
+}
+
+void Adafruit_CompositeVideo::swapBuffers(boolean copy) {
+  if (packedBuffer ? (packedBuffer == packedFront)
+                   : (frameBuffer == frontBuffer))
+    return; // Not double-buffered (or not running)
+
+  // Buffers are swapped in the interrupt handler, at the end of the
+  // field: before expanding any lines from the new one (packed), or
+  // while the DMA is in vertical sync, with a couple of milliseconds
+  // before it fetches a pixel descriptor to re-point them all (16-bit).
+  // Waiting for that here, however late this wakes up, can't tear a
+  // field. If this IS an interrupt handler, that can't happen until it
+  // returns, so the copy is left to the DMA interrupt too.
+  if (__get_IPSR()) {
+    swapCopy = copy;
+    swapPending = true;
+    return;
+  }
+  swapPending = true;
+  while (swapPending)
+    waitForVBlank();
+  if (!copy)
+    return;
+  if (packedBuffer)
+    memcpy(packedBuffer, packedFront, packedBytes());
+  else
+    memcpy(frameBuffer, frontBuffer,
+           sizeof(uint16_t) * videoSpec[mode].rowPixelClocks * HEIGHT);
+}
+
+void Adafruit_CompositeVideo::setScrollX(int16_t x) {
+  x %= WIDTH;
+  scrollX = (x < 0) ? x + WIDTH : x;
+  scrollPending = true;
+}
+
+void Adafruit_CompositeVideo::setScrollY(int16_t y) {
+  y %= HEIGHT;
+  scrollY = (y < 0) ? y + HEIGHT : y;
+  scrollPending = true;
+}
+
+void Adafruit_CompositeVideo::setRasterProgram(
+    const CompositeRasterLine *program) {
+  __disable_irq(); // Both change together as far as the interrupt knows
+  rasterNext = program;
+  scrollPending = true;
+  __enable_irq();
+}
+
+boolean Adafruit_CompositeVideo::setRowHeight(uint8_t lines, int16_t top) {
+  uint16_t used = lines * HEIGHT, total = videoSpec[mode].scanlines;
+  if (used > total)
+    return false; // Doesn't fit
+  if (top < 0)
+    top = (total - used) / 2; // Center
+  else if ((top + used) > total)
+    return false;
+  __disable_irq();
+  rowLinesNext = lines;
+  rowTopNext = top;
+  scrollPending = true;
+  __enable_irq();
+  return true;
+}
+
+uint16_t Adafruit_CompositeVideo::getScanlines(void) const {
+  return videoSpec[mode].scanlines;
+}
+
+// Hacky stuff, don't use this (use waitForVBlank() or onVBlank() instead)
+void Adafruit_CompositeVideo::setBlank(uint8_t value) { vBlank = value; }
 
 // Ditto
-uint8_t Adafruit_NTSC40x24::getBlank(void) { return vBlank; }
+uint8_t Adafruit_CompositeVideo::getBlank(void) { return vBlank; }
+
+// VERTICAL BLANK HANDLING -------------------------------------------------
+
+// Called from the DMAC interrupt (via Adafruit_ZeroDMA) each time one of
+// the field-end descriptors completes, or in packed modes also each time
+// a line buffer has been output. By the time this runs, a field-end
+// descriptor has already written the field number to fieldEnd.
+void Adafruit_CompositeVideo::dmaCallback(Adafruit_ZeroDMA *dma) {
+  (void)dma;
+  Adafruit_CompositeVideo *v = activeVideo;
+  if (v) {
+    uint8_t f = fieldEnd;
+    if (f) {
+      fieldEnd = 0;
+      vBlank = f;
+      v->endOfField(f);
+      v->fieldCount++;
+      // More than one field's time since the last one means interrupts
+      // were held off long enough to miss some
+      uint32_t now = micros();
+      if (v->lastFieldMicros) {
+        uint32_t n = (now - v->lastFieldMicros + v->fieldMicros / 2) /
+                     v->fieldMicros;
+        if (n > 1)
+          v->stats.missedFields += n - 1;
+      }
+      v->lastFieldMicros = now;
+      if (v->vBlankCallback) {
+        (*v->vBlankCallback)(f);
+        uint32_t t = micros() - now;
+        v->stats.callbackMicros = t;
+        if (t > v->stats.callbackMax)
+          v->stats.callbackMax = t;
+      }
+    } else {
+      v->endOfLine(); // Packed modes only
+    }
+  }
+}
+
+// A DMA bus error stops the channel (and video) -- rare, but counted.
+void Adafruit_CompositeVideo::dmaErrorCallback(Adafruit_ZeroDMA *dma) {
+  (void)dma;
+  if (activeVideo)
+    activeVideo->stats.dmaErrors++;
+}
+
+CompositeStats Adafruit_CompositeVideo::getStats(void) const {
+  __disable_irq(); // Consistent snapshot, not torn by the interrupt
+  CompositeStats s = stats;
+  s.fields = fieldCount;
+  __enable_irq();
+  return s;
+}
+
+void Adafruit_CompositeVideo::resetStats(void) {
+  __disable_irq();
+  stats.missedFields = 0;
+  stats.callbackMicros = 0;
+  stats.callbackMax = 0;
+  stats.dmaErrors = 0;
+  __enable_irq();
+}
+
+void Adafruit_CompositeVideo::waitForVBlank(void) {
+  // Not running, or called from an interrupt (e.g. an onVBlank()
+  // function) that the DMA interrupt can't preempt: would wait forever
+  if (!descriptor || __get_IPSR())
+    return;
+  uint32_t f = fieldCount;
+  // Any interrupt wakes the CPU from WFE, so the count is re-checked
+  // after each; most wakeups are just the 1 ms SysTick.
+  while (fieldCount == f)
+    __WFE();
+}
+
+// ALL-PURPOSE GFX PIXEL DRAWING FUNCTION ----------------------------------
+
+uint16_t Adafruit_CompositeVideo::grayToDAC(uint8_t gray) {
+  return grayLUT[gray];
+}
+
+void Adafruit_CompositeVideo::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    return;
+  (this->*pixelWriter)(x, y, color);
+}
+
+void Adafruit_CompositeVideo::writePixel(int16_t x, int16_t y,
+                                         uint16_t color) {
+  if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    return;
+  (this->*pixelWriter)(x, y, color);
+}
+
+// The rotation is a template parameter, so each instance compiles down to
+// just its own coordinate swap, with no switch.
+template <uint8_t r>
+void Adafruit_CompositeVideo::rotatedPixel(int16_t x, int16_t y,
+                                           uint8_t gray) {
+  if (r == 1)
+    writeNative(WIDTH - 1 - y, x, gray);
+  else if (r == 2)
+    writeNative(WIDTH - 1 - x, HEIGHT - 1 - y, gray);
+  else if (r == 3)
+    writeNative(y, HEIGHT - 1 - x, gray);
+  else
+    writeNative(x, y, gray);
+}
+
+void Adafruit_CompositeVideo::setRotation(uint8_t r) {
+  static const PixelWriter writers[] = {
+      &Adafruit_CompositeVideo::rotatedPixel<0>,
+      &Adafruit_CompositeVideo::rotatedPixel<1>,
+      &Adafruit_CompositeVideo::rotatedPixel<2>,
+      &Adafruit_CompositeVideo::rotatedPixel<3>};
+  Adafruit_GFX::setRotation(r);
+  pixelWriter = writers[rotation];
+}
+
+// Store one pixel in unrotated framebuffer coordinates, in whichever
+// format the framebuffer uses.
+void Adafruit_CompositeVideo::writeNative(int16_t x, int16_t y, uint8_t gray) {
+  if (flags & COMPOSITE_TEXT) {
+    return; // No pixels to draw to, only character cells
+  } else if (!packedBuffer) {
+    frameBuffer[y * videoSpec[mode].rowPixelClocks + x +
+                videoSpec[mode].xOffset] = grayToDAC(gray);
+  } else if (flags & COMPOSITE_PACKED4) {
+    uint8_t *p = &packedBuffer[y * ((WIDTH + 1) / 2) + x / 2];
+    if (x & 1)
+      *p = (*p & 0xF0) | (gray >> 4);
+    else
+      *p = (*p & 0x0F) | (gray & 0xF0);
+  } else {
+    packedBuffer[y * WIDTH + x] = gray;
+  }
+}
+
+// BULK DRAWING FUNCTIONS --------------------------------------------------
+// These override the Adafruit_GFX defaults (which call drawPixel() for
+// every pixel), clipping once and converting brightness once.
+
+void Adafruit_CompositeVideo::fillNative(int16_t x, int16_t y, int16_t w,
+                                         int16_t h, uint8_t gray) {
+  if (flags & COMPOSITE_TEXT) {
+    return;
+  } else if (flags & COMPOSITE_PACKED4) {
+    for (int16_t j = 0; j < h; j++) {
+      for (int16_t i = 0; i < w; i++)
+        writeNative(x + i, y + j, gray);
+    }
+  } else if (packedBuffer) {
+    uint8_t *row = &packedBuffer[y * WIDTH + x];
+    while (h--) {
+      memset(row, gray, w);
+      row += WIDTH;
+    }
+  } else {
+    uint8_t rpc = videoSpec[mode].rowPixelClocks;
+    uint16_t level = grayToDAC(gray);
+    uint16_t *row = &frameBuffer[y * rpc + x + videoSpec[mode].xOffset];
+    while (h--) {
+      fillLevel(row, w, level);
+      row += rpc;
+    }
+  }
+}
+
+void Adafruit_CompositeVideo::fillRect(int16_t x, int16_t y, int16_t w,
+                                       int16_t h, uint16_t color) {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+  // Clip to screen (in rotated coordinates)
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if ((x + w) > _width)
+    w = _width - x;
+  if ((y + h) > _height)
+    h = _height - y;
+  if ((w <= 0) || (h <= 0))
+    return;
+
+  // Then rotate the clipped rectangle to framebuffer coordinates
+  uint8_t level = color;
+  switch (rotation) {
+  case 0:
+    fillNative(x, y, w, h, level);
+    break;
+  case 1:
+    fillNative(WIDTH - y - h, x, h, w, level);
+    break;
+  case 2:
+    fillNative(WIDTH - x - w, HEIGHT - y - h, w, h, level);
+    break;
+  case 3:
+    fillNative(y, HEIGHT - x - w, h, w, level);
+    break;
+  }
+}
+
+void Adafruit_CompositeVideo::fillScreen(uint16_t color) {
+  fillNative(0, 0, WIDTH, HEIGHT, color);
+}
+
+void Adafruit_CompositeVideo::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                            uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_CompositeVideo::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                            uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_CompositeVideo::drawGrayscaleBitmap(int16_t x, int16_t y,
+                                                  uint8_t *bitmap, int16_t w,
+                                                  int16_t h) {
+  // Clip to screen (in rotated coordinates); bitmap rows keep their
+  // original stride (bw)
+  int16_t bw = w;
+  if (x < 0) {
+    bitmap -= x;
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    bitmap -= y * bw;
+    h += y;
+    y = 0;
+  }
+  if ((x + w) > _width)
+    w = _width - x;
+  if ((y + h) > _height)
+    h = _height - y;
+  if ((w <= 0) || (h <= 0))
+    return;
+
+  if (rotation || packedBuffer) { // Pixel at a time, but already clipped
+    for (int16_t j = 0; j < h; j++) {
+      for (int16_t i = 0; i < w; i++)
+        (this->*pixelWriter)(x + i, y + j, bitmap[i]);
+      bitmap += bw;
+    }
+    return;
+  }
+
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  uint16_t *row = &frameBuffer[y * rpc + x + videoSpec[mode].xOffset];
+  while (h--) {
+    for (int16_t i = 0; i < w; i++)
+      row[i] = grayToDAC(bitmap[i]);
+    bitmap += bw;
+    row += rpc;
+  }
+}
+
+void Adafruit_CompositeVideo::drawGrayscaleBitmap(int16_t x, int16_t y,
+                                                  const uint8_t bitmap[],
+                                                  int16_t w, int16_t h) {
+  // PROGMEM is just regular (flash) memory on SAMD, to the CPU it reads
+  // the same as RAM, so the RAM version can be used directly.
+  drawGrayscaleBitmap(x, y, (uint8_t *)bitmap, w, h);
+}
+
+// STREAMED FRAMES ---------------------------------------------------------
+// A stream is a CompositeStreamHeader followed by frames already in the
+// back buffer's own format, so playback is just reading each one into
+// getFrameData() and swapping; no per-pixel work at all.
+
+uint8_t *Adafruit_CompositeVideo::getFrameData(uint32_t *bytes) {
+  // Both buffer pointers are NULL from the constructor until begin()
+  // and again after end(), so this can be called any time.
+  uint8_t *p = NULL;
+  uint32_t n = 0;
+  if (packedBuffer) {
+    p = packedBuffer;
+    n = packedBytes();
+  } else if (frameBuffer) {
+    p = (uint8_t *)frameBuffer;
+    n = sizeof(uint16_t) * videoSpec[mode].rowPixelClocks * HEIGHT;
+  }
+  if (bytes)
+    *bytes = n;
+  return p;
+}
+
+boolean
+Adafruit_CompositeVideo::checkStream(const CompositeStreamHeader *h) const {
+  if (memcmp(h->magic, "CVID", 4) ||
+      (h->version != COMPOSITE_STREAM_VERSION) || (h->width != WIDTH) ||
+      (h->height != HEIGHT))
+    return false;
+  if (h->format == COMPOSITE_STREAM_RLE) // Decoded, so any pixel format
+    return !(flags & COMPOSITE_TEXT);
+  uint32_t n = packedBytes();
+  if (!n)
+    n = sizeof(uint16_t) * videoSpec[mode].rowPixelClocks * HEIGHT;
+  return (h->format == (flags & LINEBUFFER_FLAGS)) && (h->frameBytes == n);
+}
+
+// RLE frames are a series of codes covering every pixel in order, with
+// runs carrying on from one row to the next:
+//   0x00-0x7F  skip 1-128 pixels (unchanged from the previous frame)
+//   0x80-0xBF  run of 1-64 pixels, value in the next byte
+//   0xC0-0xFF  1-64 literal pixel values follow
+// Each code is split at row ends, and runs go through fillNative(), so
+// pixels are converted once per run and written directly, nothing goes
+// through drawPixel().
+const uint8_t *Adafruit_CompositeVideo::drawRLEFrame(const uint8_t *frame) {
+  if (flags & COMPOSITE_TEXT)
+    return NULL;
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  int16_t x = 0, y = 0;
+  while (y < HEIGHT) {
+    uint8_t code = *frame++;
+    int16_t n = (code & ((code & 0x80) ? 0x3F : 0x7F)) + 1;
+    while (n > 0) {
+      if (y >= HEIGHT)
+        return NULL; // Past the last pixel, bad data
+      int16_t k = min(n, (int16_t)(WIDTH - x)); // Part on this row
+      if (code >= 0xC0) {
+        if (packedBuffer) {
+          for (int16_t i = 0; i < k; i++)
+            writeNative(x + i, y, frame[i]);
+        } else {
+          uint16_t *row = &frameBuffer[y * rpc + videoSpec[mode].xOffset + x];
+          for (int16_t i = 0; i < k; i++)
+            row[i] = grayToDAC(frame[i]);
+        }
+        frame += k;
+      } else if (code >= 0x80) {
+        fillNative(x, y, k, 1, *frame);
+      }
+      n -= k;
+      if ((x += k) >= WIDTH) {
+        x = 0;
+        y++;
+      }
+    }
+    if ((code & 0xC0) == 0x80)
+      frame++; // Run value
+  }
+  return frame;
+}
+
+// TEXT MODE ---------------------------------------------------------------
+// With COMPOSITE_TEXT, the framebuffer is an array of character codes
+// (textColumns() * textRows() bytes), drawn with the same 5x7 font as
+// Adafruit_GFX's default, so changing a character is a single byte write.
+
+void Adafruit_CompositeVideo::setChar(int16_t col, int16_t row, uint8_t c) {
+  if ((flags & COMPOSITE_TEXT) && (col >= 0) && (col < textColumns()) &&
+      (row >= 0) && (row < textRows()))
+    packedBuffer[row * textColumns() + col] = c;
+}
+
+// print() and println() end up here. In text mode, the GFX cursor (still
+// in pixels, so setCursor() works as usual) selects a character cell.
+// Text size and rotation are not applied, nor are custom fonts.
+size_t Adafruit_CompositeVideo::write(uint8_t c) {
+  if (!(flags & COMPOSITE_TEXT))
+    return Adafruit_GFX::write(c);
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += 8;
+  } else if (c != '\r') {
+    if (wrap && ((cursor_x + 6) > WIDTH)) {
+      cursor_x = 0;
+      cursor_y += 8;
+    }
+    if (!_cp437 && (c >= 176))
+      c++; // Same off-by-one fix as Adafruit_GFX::drawChar()
+    setChar(cursor_x / 6, cursor_y / 8, c);
+    cursor_x += 6;
+  }
+  return 1;
+}
+
+// RESOLUTION-SPECIFIC CLASSES ---------------------------------------------
+//
+// THESE are what user code instantiates.
+
+// Constructors
+Adafruit_NTSC40x24::Adafruit_NTSC40x24()
+    : Adafruit_CompositeVideo(MODE_NTSC40x24, 40, 24) {}
+
+Adafruit_NTSC80x24::Adafruit_NTSC80x24()
+    : Adafruit_CompositeVideo(MODE_NTSC80x24, 80, 24) {}
+
+Adafruit_NTSC80x48::Adafruit_NTSC80x48()
+    : Adafruit_CompositeVideo(MODE_NTSC80x48, 80, 48) {}
+
+Adafruit_PAL40x25::Adafruit_PAL40x25()
+    : Adafruit_CompositeVideo(MODE_PAL40x25, 40, 25) {}
+
+Adafruit_NTSC40x48::Adafruit_NTSC40x48()
+    : Adafruit_CompositeVideo(MODE_NTSC40x48, 40, 48) {}
+
+#if defined(__SAMD51__)
+Adafruit_NTSC160x96::Adafruit_NTSC160x96()
+    : Adafruit_CompositeVideo(MODE_NTSC160x96, 160, 96) {}
+#endif
+
+// DIRTY-RECTANGLE CANVAS --------------------------------------------------
+// Drawing goes to the GFXcanvas8 buffer as usual; each primitive also
+// grows a single bounding rectangle (in unrotated buffer coordinates),
+// and flush() converts just that rectangle into the display.
+
+Adafruit_CompositeCanvas::Adafruit_CompositeCanvas(uint16_t w, uint16_t h)
+    : GFXcanvas8(w, h), dirtyX0(0), dirtyY0(0), dirtyX1(w - 1),
+      dirtyY1(h - 1) {}
+
+void Adafruit_CompositeCanvas::drawPixel(int16_t x, int16_t y,
+                                         uint16_t color) {
+  GFXcanvas8::drawPixel(x, y, color);
+  markDirty(x, y, 1, 1);
+}
+
+void Adafruit_CompositeCanvas::fillRect(int16_t x, int16_t y, int16_t w,
+                                        int16_t h, uint16_t color) {
+  GFXcanvas8::fillRect(x, y, w, h, color);
+  markDirty(x, y, w, h);
+}
+
+void Adafruit_CompositeCanvas::fillScreen(uint16_t color) {
+  GFXcanvas8::fillScreen(color);
+  dirtyX0 = dirtyY0 = 0;
+  dirtyX1 = WIDTH - 1;
+  dirtyY1 = HEIGHT - 1;
+}
+
+void Adafruit_CompositeCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                             uint16_t color) {
+  GFXcanvas8::drawFastHLine(x, y, w, color);
+  markDirty(x, y, w, 1);
+}
+
+void Adafruit_CompositeCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                             uint16_t color) {
+  GFXcanvas8::drawFastVLine(x, y, h, color);
+  markDirty(x, y, 1, h);
+}
+
+void Adafruit_CompositeCanvas::markDirty(int16_t x, int16_t y, int16_t w,
+                                         int16_t h) {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+  // Rotate to buffer coordinates, same as Adafruit_CompositeVideo
+  int16_t t;
+  switch (rotation) {
+  case 1:
+    t = x;
+    x = WIDTH - y - h;
+    y = t;
+    t = w;
+    w = h;
+    h = t;
+    break;
+  case 2:
+    x = WIDTH - x - w;
+    y = HEIGHT - y - h;
+    break;
+  case 3:
+    t = x;
+    x = y;
+    y = HEIGHT - t - w;
+    t = w;
+    w = h;
+    h = t;
+    break;
+  }
+  int16_t x1 = x + w - 1, y1 = y + h - 1;
+  if (x < 0)
+    x = 0;
+  if (y < 0)
+    y = 0;
+  if (x1 >= WIDTH)
+    x1 = WIDTH - 1;
+  if (y1 >= HEIGHT)
+    y1 = HEIGHT - 1;
+  if ((x > x1) || (y > y1))
+    return; // Entirely off canvas
+  if (isDirty()) {
+    if (x < dirtyX0)
+      dirtyX0 = x;
+    if (y < dirtyY0)
+      dirtyY0 = y;
+    if (x1 > dirtyX1)
+      dirtyX1 = x1;
+    if (y1 > dirtyY1)
+      dirtyY1 = y1;
+  } else {
+    dirtyX0 = x;
+    dirtyY0 = y;
+    dirtyX1 = x1;
+    dirtyY1 = y1;
+  }
+}
+
+void Adafruit_CompositeCanvas::flush(Adafruit_CompositeVideo &display,
+                                     int16_t x, int16_t y) {
+  if (!isDirty())
+    return;
+  // One row at a time, since drawGrayscaleBitmap() takes no stride
+  uint8_t *buf = getBuffer();
+  int16_t w = dirtyX1 - dirtyX0 + 1;
+  for (int16_t row = dirtyY0; row <= dirtyY1; row++)
+    display.drawGrayscaleBitmap(x + dirtyX0, y + row,
+                                &buf[row * WIDTH + dirtyX0], w, 1);
+  dirtyX0 = 0; // Mark clean
+  dirtyX1 = -1;
+}
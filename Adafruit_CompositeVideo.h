@@ -1,10 +1,11 @@
 /*!
  * @file Adafruit_CompositeVideo.h
  *
- * DMA-driven composite video library for M0 microcontrollers
- * (Circuit Playground Express, Feather M0, Arduino Zero, etc.).
+ * DMA-driven composite video library for M0 and M4 microcontrollers
+ * (Circuit Playground Express, Feather M0/M4, Arduino Zero, etc.).
  * Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
- * Handles grayscale NTSC video, 40x24 pixels, usable area may be smaller
+ * Handles grayscale NTSC video, 40x24, 40x48, 80x24 or 80x48 pixels, or PAL
+ * video, 40x25 pixels (plus 160x96 NTSC on M4); usable area may be smaller
  * due to overscan.
  *
  * Adafruit invests time and resources providing this open source code,
@@ -23,26 +24,400 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_ZeroDMA.h>
 
+// Option flags for begin(), may be OR'd together:
+#define COMPOSITE_DOUBLEBUFFER 0x01 ///< Draw offscreen, see swapBuffers()
+#define COMPOSITE_COMPACT 0x02      ///< Smaller DMA descriptor table
+#define COMPOSITE_PACKED4 0x04      ///< 4 bits/pixel, expanded per scanline
+#define COMPOSITE_PACKED8 0x08      ///< 8 bits/pixel, expanded per scanline
+#define COMPOSITE_TEXT 0x10         ///< 6x8 pixel character cells, no bitmap
+#define COMPOSITE_INTERLACE 0x20    ///< Rows placed on odd+even field lines
+
+// Pixel clock timers for setTimer(). Each shares its generic clock with
+// another timer, which differs between SAMD21 and SAMD51:
+#if defined(__SAMD51__)
+#define COMPOSITE_TC3 0  ///< Timer/Counter 3 (clock shared with TC2)
+#define COMPOSITE_TC4 1  ///< Timer/Counter 4 (clock shared with TC5)
+#define COMPOSITE_TC5 2  ///< Timer/Counter 5 (clock shared with TC4)
+#define COMPOSITE_TCC0 3 ///< TCC0 (clock shared with TCC1)
+#define COMPOSITE_TCC1 4 ///< TCC1 (clock shared with TCC0)
+#define COMPOSITE_TCC2 5 ///< TCC2 (clock shared with TCC3)
+#else
+#define COMPOSITE_TC3 0  ///< Timer/Counter 3 (clock shared with TCC2)
+#define COMPOSITE_TC4 1  ///< Timer/Counter 4 (clock shared with TC5)
+#define COMPOSITE_TC5 2  ///< Timer/Counter 5 (clock shared with TC4)
+#define COMPOSITE_TCC0 3 ///< TCC0 (clock shared with TCC1)
+#define COMPOSITE_TCC1 4 ///< TCC1 (clock shared with TCC0)
+#define COMPOSITE_TCC2 5 ///< TCC2 (clock shared with TC3)
+#endif
+
+// Default pixel clock timer: TC5, except on smaller SAMD51 parts (e.g.
+// SAMD51G: ItsyBitsy M4, Trellis M4) that only have TC0 to TC3.
+#if defined(TC5)
+#define COMPOSITE_TIMER COMPOSITE_TC5 ///< Default timer, see setTimer()
+#else
+#define COMPOSITE_TIMER COMPOSITE_TC3 ///< Default timer, see setTimer()
+#endif
+
+// Default generic clock for the pixel clock timer: a 48 MHz generator
+// either way (the SAMD51 CPU clock on generator 0 is 120 MHz).
+#if defined(__SAMD51__)
+#define COMPOSITE_GCLK 1            ///< Default GCLK generator, see setTimer()
+#define COMPOSITE_GCLK_HZ 48000000L ///< Its frequency
+#else
+#define COMPOSITE_GCLK 0         ///< Default GCLK generator, see setTimer()
+#define COMPOSITE_GCLK_HZ F_CPU  ///< Its frequency
+#endif
+
+#define COMPOSITE_SPRITES 8 ///< Number of sprites, see setSprite()
+#define COMPOSITE_STREAM_VERSION 1 ///< CompositeStreamHeader version
+#define COMPOSITE_STREAM_RLE 0x80  ///< Stream format, see drawRLEFrame()
+
+/**
+ * @brief  One line of a raster program, see setRasterProgram().
+ */
+typedef struct {
+  int16_t row;        ///< Framebuffer row to show, -1 = blank (see below)
+  int16_t scrollX;    ///< First column to show, packed & text modes only
+  uint8_t brightness; ///< 255 = as drawn, 0 = black, packed & text only
+} CompositeRasterLine;
+
+/**
+ * @brief  One 8x8 pixel sprite, see setSprite().
+ */
+typedef struct {
+  const uint8_t *bitmap; ///< 64 brightness values, row by row; NULL = off
+  const uint8_t *mask;   ///< 8 bytes, 1 bit/pixel, MSB = left; NULL = solid
+  int16_t x;             ///< Screen column of left edge
+  int16_t y;             ///< Screen row of top edge
+} CompositeSprite;
+
+/**
+ * @brief  Header at the start of a stream of ready-made frames, see
+ *         checkStream(). All fields are little-endian. The frames follow
+ *         directly, each frameBytes long, in exactly the layout of
+ *         getFrameData() for the display, format and size given.
+ */
+typedef struct {
+  char magic[4];       ///< "CVID"
+  uint8_t version;     ///< COMPOSITE_STREAM_VERSION
+  uint8_t format;      ///< COMPOSITE_PACKED4, _PACKED8, _TEXT, 0 or RLE
+  uint16_t width;      ///< Display width in pixels
+  uint16_t height;     ///< Display height in pixels
+  uint16_t frames;     ///< Number of frames that follow
+  uint32_t frameBytes; ///< Size of each frame, 0 if varies (RLE)
+} CompositeStreamHeader;
+
 /**
- * @brief  Class for generating composite video from a M0 microcontroller,
+ * @brief  Video timing and DMA health counters, see getStats().
+ */
+typedef struct {
+  uint32_t fields;         ///< End-of-field interrupts handled
+  uint32_t missedFields;   ///< Fields that ended with no interrupt handled
+  uint32_t callbackMicros; ///< Time spent in last onVBlank() function, uS
+  uint32_t callbackMax;    ///< Longest time in onVBlank() function, uS
+  uint32_t dmaErrors;      ///< DMA transfer errors (these stop video)
+} CompositeStats;
+
+/**
+ * @brief  Class for generating composite video from a M0 or M4 (SAMD51)
+ *         microcontroller,
  *         providing bitmapped low-resolution grayscale graphics.
  */
 class Adafruit_CompositeVideo : public Adafruit_GFX {
 public:
   /**
-   * @brief  Construct a new Adafruit_CompositeVideo object.
-   * @param  mode    Video mode, must be 0 (NTSC, others might be added
-   *                 in the future.
-   * @param  width   Framebuffer width in pixels, must be 40 (ditto).
-   * @param  height  Framebuffer height in pixels, must be 24 (same).
+   * @brief  Construct a new Adafruit_CompositeVideo object. User code
+   *         should instantiate one of the subclasses instead.
+   * @param  mode    Video mode, index into videoSpec[] table in the
+   *                 .cpp file.
+   * @param  width   Framebuffer width in pixels, must match mode.
+   * @param  height  Framebuffer height in pixels, ditto.
    */
   Adafruit_CompositeVideo(uint8_t mode, int16_t width, int16_t height);
 
   /**
    * @brief  Call to begin composite video output.
+   * @param  flags  Option flags, any combination of:
+   *                COMPOSITE_DOUBLEBUFFER to allocate a second framebuffer
+   *                for tear-free drawing (+2400 bytes for 40x24).
+   *                COMPOSITE_COMPACT to share one set of pixel descriptors
+   *                between the odd and even fields (-3472 bytes). This
+   *                relies on the DMA interrupt to alternate fields, so
+   *                long periods with interrupts disabled will momentarily
+   *                lose interlacing (image is still stable).
+   *                COMPOSITE_PACKED8 or COMPOSITE_PACKED4 (use one or the
+   *                other) to store 8 or 4 bits per pixel rather than a
+   *                16-bit DAC value per pixel clock. The DMA interrupt then
+   *                expands rows into a pair of scanline buffers just ahead
+   *                of output. Uses a small fraction of the RAM (about 1.2K
+   *                or 0.7K for 40x24) but costs some CPU time and needs
+   *                interrupts to be serviced within ~60 uS to avoid
+   *                glitches. COMPOSITE_COMPACT is implied.
+   *                COMPOSITE_TEXT (instead of PACKED8 or 4) works the same
+   *                way, but stores one byte per 6x8 pixel character cell,
+   *                drawn with the standard Adafruit_GFX font. Set text with
+   *                print() or setChar(); other drawing has no effect.
+   *                COMPOSITE_INTERLACE to divide rows among the 2 fields'
+   *                interleaved scanlines together, rather than each field
+   *                on its own, so row heights are even (no 5/4 alternation
+   *                at 48 rows) and boundaries land on half-line steps.
+   *                Has no effect with COMPOSITE_COMPACT, which shares pixel
+   *                descriptors between fields (packed and text modes do
+   *                support it, in the line expander).
+   *                If video is already running (from this or any other
+   *                object), it's stopped first, as with end(), so this
+   *                can be called again to change flags or resolution.
    * @return bool  true on success, false on failure (allocation error).
    */
-  boolean begin(void);
+  boolean begin(uint8_t flags = 0);
+
+  /**
+   * @brief  Stop composite video output and release everything begin()
+   *         took: the DMA channel, the memory allocated for the
+   *         descriptor list and framebuffer(s), and the timer and its
+   *         clock. The DAC output is left at 0 V. Scroll position,
+   *         raster program, row height and sprites are reset, so the
+   *         next begin() starts afresh (and a raster program can be
+   *         freed once this returns). Does nothing if not running. Don't
+   *         use drawing functions again until the next begin().
+   */
+  void end(void);
+
+  /**
+   * @brief  Choose the timer that paces the DMA (one beat per pixel
+   *         clock) and the generic clock generator feeding it. Call
+   *         before begin() (or after end()). The default
+   *         is TC5 (TC3 on parts without TC4 and TC5) on a 48 MHz
+   *         generator (0 on SAMD21, 1 on SAMD51), which stops the Tone
+   *         library (it uses TC5) from working alongside.
+   * @param  timer      COMPOSITE_TC3, _TC4, _TC5, _TCC0, _TCC1 or _TCC2,
+   *                    if the part has it. Timers share a clock with
+   *                    another (see each define); a non-default
+   *                    generator applies to both.
+   * @param  generator  GCLK generator number, 0 to 8 (11 on SAMD51). Any
+   *                    other than the default must already be set up and
+   *                    running by the sketch,
+   *                    e.g. from a faster PLL for finer timing steps.
+   * @param  hz         Frequency of that generator, default 48 MHz. Pixel
+   *                    clocks keep each mode's timing, rounded to a whole
+   *                    number of this clock's ticks.
+   * @return bool       true on success, false if timer or generator is
+   *                    out of range or not on this part, or video is
+   *                    running.
+   */
+  boolean setTimer(uint8_t timer, uint8_t generator = COMPOSITE_GCLK,
+                   uint32_t hz = COMPOSITE_GCLK_HZ);
+
+  /**
+   * @brief  Clear framebuffer; set all pixels to 0 (black). If double-
+   *         buffered, this clears the back (drawing) buffer.
+   */
+  void clear(void);
+
+  /**
+   * @brief  Show the back buffer, waiting for the next vertical blank so
+   *         there's no tearing. Only the DMA descriptors' source addresses
+   *         are changed, no pixels are copied. Drawing then continues in
+   *         the buffer that was previously shown. Has no effect if
+   *         COMPOSITE_DOUBLEBUFFER was not passed to begin(). From an
+   *         onVBlank() function or other interrupt handler it doesn't
+   *         wait: buffers (and the copy, if any) swap at the end of the
+   *         current field, and drawing mustn't resume until then (see
+   *         getFieldCount()).
+   * @param  copy  If true, the newly-shown frame is also copied to the new
+   *               back buffer, for code that draws incrementally rather
+   *               than redrawing the whole frame each time.
+   */
+  void swapBuffers(boolean copy = false);
+
+  /**
+   * @brief  Same as swapBuffers(false), for similarity to other displays.
+   */
+  void display(void) { swapBuffers(false); }
+
+  /**
+   * @brief  Scroll the display vertically, wrapping around: framebuffer
+   *         row y is shown at the top. Only DMA descriptor addresses
+   *         change (or, in packed and text modes, which row each scanline
+   *         is expanded from), no pixels are moved. Takes effect at the
+   *         next vertical blank; doesn't wait for it. Unaffected by
+   *         rotation, this is always in framebuffer rows.
+   * @param  y  Framebuffer row to show at top, any value (taken modulo
+   *            the framebuffer height).
+   */
+  void setScrollY(int16_t y);
+
+  /**
+   * @brief  Scroll the display horizontally, wrapping around: framebuffer
+   *         column x is shown at the left edge. Packed and text modes only
+   *         (COMPOSITE_PACKED8/4 or COMPOSITE_TEXT), where each scanline
+   *         is expanded starting from that column. Rows in other modes
+   *         include sync and blanking, which can't be offset, so this has
+   *         no visible effect there. Takes effect at the next vertical
+   *         blank. Unaffected by rotation.
+   * @param  x  Framebuffer column to show at left, any value (taken
+   *            modulo the framebuffer width).
+   */
+  void setScrollX(int16_t x);
+
+  /**
+   * @brief   Get the horizontal scroll position set by setScrollX().
+   * @return  int16_t  Framebuffer column at left edge, 0 to WIDTH-1.
+   */
+  int16_t getScrollX(void) const { return scrollX; }
+
+  /**
+   * @brief   Get the vertical scroll position set by setScrollY().
+   * @return  int16_t  Framebuffer row at top edge, 0 to HEIGHT-1.
+   */
+  int16_t getScrollY(void) const { return scrollY; }
+
+  /**
+   * @brief  Set a raster program, choosing what appears on every scanline
+   *         of each field: which framebuffer row, and (packed and text
+   *         modes only) the first column and a brightness. Like scrolling,
+   *         this is all done by re-pointing DMA descriptors (or in the
+   *         line expander), for split screens, fixed status bars, vertical
+   *         zoom and so on without redrawing. Takes effect at the next
+   *         vertical blank; after changing a program that's already set,
+   *         call this again so the change is picked up cleanly. While a
+   *         program is set, setScrollX() and setScrollY() are ignored.
+   *         Lines with row -1 (or any row outside the framebuffer) are
+   *         blank: blanking level, a little darker than black at the
+   *         default setLevels(), and the same in every mode.
+   * @param  program  Array of getScanlines() entries, which must remain
+   *                  valid (may be const, in flash), or NULL to return to
+   *                  the normal evenly-spaced rows.
+   */
+  void setRasterProgram(const CompositeRasterLine *program);
+
+  /**
+   * @brief   Set a fixed number of scanlines per framebuffer row and the
+   *          position of the first row, rather than spreading rows over
+   *          the whole visible area. Lines above and below are blank
+   *          (blanking level, as a raster program's row -1), the same in
+   *          every mode.
+   *          E.g. rows 8 lines tall at 40x24 (192 of 216 lines) leave a
+   *          border for overscan, or use 4 with Adafruit_NTSC40x48. Only
+   *          the DMA descriptor addresses change, at the next vertical
+   *          blank, so video stays in sync throughout.
+   * @param   lines  Scanlines per row (per field), or 0 to return to the
+   *                 default of rows spread over all getScanlines() lines.
+   * @param   top    Blank scanlines above the first row, or -1 (default)
+   *                 to center rows vertically.
+   * @return  bool   true on success, false if the rows don't fit.
+   */
+  boolean setRowHeight(uint8_t lines, int16_t top = -1);
+
+  /**
+   * @brief  Set DAC pre-emphasis, sharpening edges that the DAC would
+   *         otherwise smear at faster pixel clocks (e.g. 80-pixel modes):
+   *         each change in brightness overshoots by a fraction of the
+   *         step. Packed and text modes only (COMPOSITE_PACKED4,
+   *         COMPOSITE_PACKED8 or COMPOSITE_TEXT), so for an 80-pixel
+   *         mode use e.g. begin(COMPOSITE_PACKED8): it's applied to each
+   *         whole line as it's expanded, so it takes effect immediately
+   *         for everything on screen. 16-bit modes have no such step
+   *         (DMA reads the framebuffer directly). Call after begin();
+   *         end() turns it off again.
+   * @param  amount  Overshoot in 16ths of each step, 0 (default, off) to
+   *                 16 (step doubled). 3 to 6 is a good place to start.
+   * @return bool    true on success, false (and no effect) if not
+   *                 running in a packed or text mode.
+   */
+  boolean setPreEmphasis(uint8_t amount);
+
+  /**
+   * @brief  Set the DAC values for black and white, e.g. to add contrast
+   *         on a monitor that looks washed out. Rebuilds the brightness
+   *         table (in RAM, about 0.5K, unless back to the defaults) and
+   *         converts anything already in the running display's 16-bit
+   *         framebuffer, so the next field shows the change. The table
+   *         is shared by all display objects, whichever this is called
+   *         on. Packed and text modes keep gray values, so they're always
+   *         exact; 16-bit pixels are matched to the nearest old level,
+   *         which can't tell apart grays the old table gave the same DAC
+   *         value (e.g. dark grays at a high gamma), so redraw for an
+   *         exact picture after that. Only black and white are
+   *         adjustable; the sync (0) and blanking (45) levels are fixed.
+   * @param  black  DAC value for brightness 0; default 60, must be at
+   *                least the blanking level (45). All levels are 4X on
+   *                SAMD51, whose DAC is 12 bits.
+   * @param  white  DAC value for brightness 255; default 310 (1.0 Volt),
+   *                up to 1023.
+   * @return bool   true on success, false if levels are out of range or
+   *                there's not enough memory.
+   */
+  boolean setLevels(uint16_t black, uint16_t white);
+
+  /**
+   * @brief  Set the gamma curve from brightness to DAC value, rebuilding
+   *         the brightness table the same as setLevels().
+   * @param  gamma  1.0 (default) is linear; above 1.0 darkens midtones
+   *                (for monitors that look washed out), below 1.0
+   *                lightens them.
+   * @return bool   true on success, false if gamma is not above 0 or
+   *                there's not enough memory.
+   */
+  boolean setGamma(float gamma);
+
+  /**
+   * @brief  Show or change one of COMPOSITE_SPRITES 8x8 pixel sprites,
+   *         drawn over the image as each line is expanded. Sprites need
+   *         begin() with COMPOSITE_PACKED4, COMPOSITE_PACKED8 or
+   *         COMPOSITE_TEXT; 16-bit framebuffer modes (the default) don't
+   *         support them. The framebuffer is untouched, so nothing
+   *         needs redrawing when a sprite moves. Changes take effect at
+   *         the next vertical blank. Sprites are positioned on screen,
+   *         ignoring scrolling (with a raster program, y is compared with
+   *         each line's row). Higher-numbered sprites are on top.
+   * @param  n       Sprite number, 0 to COMPOSITE_SPRITES-1.
+   * @param  x       Screen column of left edge, may be partly offscreen.
+   * @param  y       Screen row of top edge, may be partly offscreen.
+   * @param  bitmap  64 brightness values (0-255), left to right and top to
+   *                 bottom; must remain valid while shown. NULL hides the
+   *                 sprite.
+   * @param  mask    Optional transparency mask, one byte per row, bit 7 =
+   *                 left pixel, 1 = drawn (same as drawGrayscaleBitmap()
+   *                 masks). NULL (default) draws all 64 pixels.
+   * @return bool    true on success, false if n is out of range or not
+   *                 running in a packed or text mode.
+   */
+  boolean setSprite(uint8_t n, int16_t x, int16_t y, const uint8_t *bitmap,
+                 const uint8_t *mask = NULL);
+
+  /**
+   * @brief  Move a sprite set with setSprite(), at the next vertical blank.
+   * @param  n  Sprite number, 0 to COMPOSITE_SPRITES-1.
+   * @param  x  Screen column of left edge.
+   * @param  y  Screen row of top edge.
+   * @return bool  true on success, false if n is out of range or not
+   *               running in a packed or text mode.
+   */
+  boolean moveSprite(uint8_t n, int16_t x, int16_t y);
+
+  /**
+   * @brief   Get the number of visible scanlines per field, i.e. the
+   *          length of a raster program.
+   * @return  uint16_t  Scanline count, 216 for NTSC, 250 for PAL.
+   */
+  uint16_t getScanlines(void) const;
+
+  /**
+   * @brief  Set current field number, used in kludgey vertical blank
+   *         synchronization. Deprecated, use waitForVBlank() or
+   *         onVBlank() instead.
+   * @param  value  Typically 0 to indicate nonsense field number,
+   *                then getBlank() is used to poll for a specific field.
+   */
+  void setBlank(uint8_t value);
+
+  /**
+   * @brief   Get current NTSC field number. Deprecated, use
+   *          waitForVBlank() or onVBlank() instead.
+   * @return  uint8_t  1 if odd-numbered field, 2 if even-numbered.
+   */
+  uint8_t getBlank(void);
 
   /**
    * @brief  Pixel-drawing function for Adafruit_GFX.
@@ -52,16 +427,440 @@ public:
    */
   void drawPixel(int16_t x, int16_t y, uint16_t color);
 
+  /**
+   * @brief  Same as drawPixel(), for Adafruit_GFX primitives that use it
+   *         (lines, circles, text), minus a virtual call per pixel.
+   * @param  x      Pixel column (0 = left edge, unless rotation used).
+   * @param  y      Pixel row (0 = top edge, unless rotation used).
+   * @param  color  Pixel brightness, 0 (black) to 255 (white).
+   */
+  void writePixel(int16_t x, int16_t y, uint16_t color);
+
+  /**
+   * @brief  Set display rotation, as with any Adafruit_GFX display. Also
+   *         selects a pixel writer specialized for that rotation, so
+   *         drawPixel() doesn't decide how to rotate on every call.
+   * @param  r  Rotation, 0 to 3 (quarter turns clockwise).
+   */
+  void setRotation(uint8_t r);
+
+  /**
+   * @brief  Fill a rectangle, writing framebuffer rows directly rather
+   *         than going through drawPixel() for each pixel.
+   * @param  x      Left edge (unless rotation used).
+   * @param  y      Top edge (unless rotation used).
+   * @param  w      Width in pixels.
+   * @param  h      Height in pixels.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+  /**
+   * @brief  Fill the whole screen with one brightness.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void fillScreen(uint16_t color);
+
+  /**
+   * @brief  Draw a horizontal line, see fillRect().
+   * @param  x      Left end (unless rotation used).
+   * @param  y      Row (unless rotation used).
+   * @param  w      Length in pixels.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+
+  /**
+   * @brief  Draw a vertical line, see fillRect().
+   * @param  x      Column (unless rotation used).
+   * @param  y      Top end (unless rotation used).
+   * @param  h      Length in pixels.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+
+  using Adafruit_GFX::drawGrayscaleBitmap; // Keep masked variants visible
+
+  /**
+   * @brief  Draw an 8-bit grayscale bitmap (e.g. from a GFXcanvas8),
+   *         converting whole rows straight into the framebuffer. With
+   *         rotation set, this falls back on the Adafruit_GFX version.
+   * @param  x       Left edge (unless rotation used).
+   * @param  y       Top edge (unless rotation used).
+   * @param  bitmap  Pixel brightnesses, 0 (black) to 255 (white),
+   *                 w * h bytes.
+   * @param  w       Bitmap width in pixels.
+   * @param  h       Bitmap height in pixels.
+   */
+  void drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w,
+                           int16_t h);
+
+  /**
+   * @brief  Draw an 8-bit grayscale bitmap from flash (PROGMEM), same as
+   *         the RAM version otherwise.
+   * @param  x       Left edge (unless rotation used).
+   * @param  y       Top edge (unless rotation used).
+   * @param  bitmap  Pixel brightnesses, 0 (black) to 255 (white),
+   *                 w * h bytes.
+   * @param  w       Bitmap width in pixels.
+   * @param  h       Bitmap height in pixels.
+   */
+  void drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                           int16_t w, int16_t h);
+
+  /**
+   * @brief  Set one character cell in COMPOSITE_TEXT mode (the back buffer,
+   *         if double-buffered). Has no effect in other modes.
+   * @param  col  Column, 0 to textColumns()-1 (out of range is ignored).
+   * @param  row  Row, 0 to textRows()-1 (ditto).
+   * @param  c    Character code, same font as Adafruit_GFX (code page 437
+   *              style layout).
+   */
+  void setChar(int16_t col, int16_t row, uint8_t c);
+
+  /**
+   * @brief   Get the character cell array in COMPOSITE_TEXT mode, for code
+   *          that writes text directly.
+   * @return  uint8_t*  textColumns() * textRows() bytes, row by row, or
+   *                    NULL if not in text mode (or begin() not called).
+   */
+  uint8_t *getTextBuffer(void) const {
+    return (flags & COMPOSITE_TEXT) ? packedBuffer : NULL;
+  }
+
+  /**
+   * @brief   Get the number of character columns in COMPOSITE_TEXT mode.
+   * @return  uint8_t  WIDTH / 6.
+   */
+  uint8_t textColumns(void) const { return WIDTH / 6; }
+
+  /**
+   * @brief   Get the number of character rows in COMPOSITE_TEXT mode.
+   * @return  uint8_t  HEIGHT / 8.
+   */
+  uint8_t textRows(void) const { return HEIGHT / 8; }
+
+  /**
+   * @brief   Character output for print(). In COMPOSITE_TEXT mode this
+   *          stores characters in cells at the GFX cursor position (text
+   *          size and rotation are ignored), otherwise it's the usual
+   *          Adafruit_GFX text drawing.
+   * @param   c  Character code.
+   * @return  size_t  1.
+   */
+  size_t write(uint8_t c);
+
+  /**
+   * @brief  Set a function to be called at the start of every vertical
+   *         blank (end of each field's pixel data). This is called from
+   *         the DMA interrupt handler, so keep it short, and anything it
+   *         shares with the main loop should be declared volatile.
+   * @param  callback  Function receiving the field number that just
+   *                   ended (1 = odd, 2 = even), or NULL to disable.
+   */
+  void onVBlank(void (*callback)(uint8_t field)) {
+    vBlankCallback = callback;
+  }
+
+  /**
+   * @brief  Wait for the start of the next vertical blank. The CPU sleeps
+   *         (WFE) in the meantime rather than busy-waiting, though other
+   *         interrupts (millis(), etc.) still wake it briefly. Returns
+   *         immediately if called from an onVBlank() function or any
+   *         other interrupt handler, where the DMA interrupt that ends
+   *         the wait could never run.
+   */
+  void waitForVBlank(void);
+
+  /**
+   * @brief   Get the number of video fields output since begin().
+   * @return  uint32_t  Field count, increments ~60 times/sec on NTSC.
+   */
+  uint32_t getFieldCount(void) const { return fieldCount; }
+
+  /**
+   * @brief   Get video timing and DMA health counters: fields handled and
+   *          missed (the total output is the sum of the two), time spent
+   *          in the onVBlank() function, and DMA errors. Missed fields
+   *          mean interrupts were held off for more than a whole field;
+   *          a callback time close to a field (~16.7 mS NTSC, 20 PAL)
+   *          means vertical blank work won't keep up.
+   * @return  CompositeStats  Snapshot of the counters.
+   */
+  CompositeStats getStats(void) const;
+
+  /**
+   * @brief  Reset the counters in getStats() to zero, other than fields
+   *         (which is the same as getFieldCount()). Also done by begin().
+   */
+  void resetStats(void);
+
+  /**
+   * @brief   Get the amount of RAM allocated by begin() for the DMA
+   *          descriptor table and framebuffer(s).
+   * @return  uint32_t  Size in bytes, 0 if begin() not yet called.
+   */
+  uint32_t memoryUsage(void) const { return allocated; }
+
+  /**
+   * @brief   Get the drawing (back) buffer as raw bytes, to load a
+   *          ready-made frame straight into it (e.g. by DMA from SPI
+   *          flash or SD, so the CPU never copies it) before calling
+   *          swapBuffers(). Packed and text modes hold pixels or cells
+   *          row by row. 16-bit modes hold whole scanline rows of DAC
+   *          values including sync, rowPixelClocks values each, so such
+   *          frames only suit the display class they were made for.
+   *          Without COMPOSITE_DOUBLEBUFFER this is the buffer being
+   *          shown, and loading into it may tear.
+   * @param   bytes  If not NULL, receives the frame size in bytes.
+   * @return  uint8_t*  Start of the back buffer, or NULL (and bytes 0)
+   *                    if begin() has not been called, or after end().
+   */
+  uint8_t *getFrameData(uint32_t *bytes = NULL);
+
+  /**
+   * @brief   Check that a stream's frames can be loaded as-is into
+   *          getFrameData() with the current display and flags, or for
+   *          COMPOSITE_STREAM_RLE, drawn with drawRLEFrame().
+   * @param   header  Header read from the start of the stream.
+   * @return  bool    true if compatible, false if not (wrong format,
+   *                  dimensions or version, or not a stream).
+   */
+  boolean checkStream(const CompositeStreamHeader *header) const;
+
+  /**
+   * @brief   Decode one run-length/delta compressed frame (as made by
+   *          extras/rle_encode.py) into the framebuffer, in framebuffer
+   *          coordinates (rotation is not applied). Pixels the frame
+   *          skips are left as they are, so the buffer must hold the
+   *          previous frame: call this during vertical blank without
+   *          COMPOSITE_DOUBLEBUFFER, or use swapBuffers(true). Works in
+   *          all but text mode.
+   * @param   frame  Frame data, in flash or RAM. Frames follow one
+   *                 another directly after the CompositeStreamHeader.
+   * @return  const uint8_t*  Start of the next frame's data, or NULL if
+   *                          this one is invalid (runs past the end of
+   *                          the image) or in text mode.
+   */
+  const uint8_t *drawRLEFrame(const uint8_t *frame);
+
 protected:
-  const uint8_t mode;         ///< Video mode, only MODE_NTSC40x24 right now
-  Adafruit_ZeroDMA dma;       ///< SAMD DMA object
-  DmacDescriptor *descriptor; ///< DMA descriptor list
-  uint16_t *frameBuffer;      ///< Pixel data
+  static void dmaCallback(Adafruit_ZeroDMA *dma); ///< DMA interrupt handler
+  static void dmaErrorCallback(Adafruit_ZeroDMA *dma); ///< DMA error handler
+
+  /**
+   * @brief  Fill the DMA descriptor table for the current mode & flags.
+   */
+  void buildDescriptors(void);
+
+  /**
+   * @brief  Start the pixel clock timer chosen with setTimer().
+   * @param  period  Timer ticks per pixel clock, minus 1.
+   */
+  void startTimer(uint32_t period);
+
+  /**
+   * @brief  Stop the pixel clock timer.
+   */
+  void stopTimer(void);
+
+  /**
+   * @brief   Get this DMA channel's slot in the DMA controller's shared
+   *          descriptor table (set up by Adafruit_ZeroDMA), where the
+   *          first descriptor of the list goes.
+   * @return  DmacDescriptor*  First descriptor for this channel.
+   */
+  DmacDescriptor *baseDescriptor(void);
+
+  /**
+   * @brief   Find the distinct halflines in the vsync tables, for
+   *          COMPOSITE_VSYNC_RAM (see .cpp).
+   * @return  uint8_t  Number of distinct halflines, 0 if too many.
+   */
+  uint8_t findHalflines(void);
+
+  /**
+   * @brief   Build (or count) the chain of DMA descriptors replacing one
+   *          field's vsync table, for COMPOSITE_VSYNC_RAM (see .cpp).
+   * @param   f      Field, 0 = odd, 1 = even.
+   * @param   head   Field's vsync descriptor in the list, or NULL to only
+   *                 count descriptors.
+   * @param   chain  Where the rest of the chain goes.
+   * @return  uint16_t  Number of descriptors, including head.
+   */
+  uint16_t chainVsync(uint8_t f, DmacDescriptor *head, DmacDescriptor *chain);
+
+  /**
+   * @brief  Point all pixel data DMA descriptors at a framebuffer.
+   * @param  buf  Framebuffer, rowPixelClocks * HEIGHT words.
+   */
+  void pointDescriptors(uint16_t *buf);
+
+  /**
+   * @brief  Called from the DMA interrupt at the end of each field,
+   *         before any user vertical blank function. Re-links the
+   *         compact descriptor layout for the next field.
+   * @param  field  Field that just ended (1 = odd, 2 = even).
+   */
+  void endOfField(uint8_t field);
+
+  /**
+   * @brief  Called from the DMA interrupt at the end of each scanline in
+   *         packed modes, refills the line buffer just output.
+   */
+  void endOfLine(void);
+
+  /**
+   * @brief  Expand one packed framebuffer row into a line buffer.
+   * @param  buf   Line buffer index, 0 or 1.
+   * @param  line  Scanline (0 to videoSpec[mode].scanlines-1).
+   */
+  void expandLine(uint8_t buf, uint16_t line);
+
+  /**
+   * @brief  Draw any sprites crossing a screen row into a line buffer.
+   * @param  dst   First visible DAC value in line buffer.
+   * @param  row   Screen row, 0 to HEIGHT-1.
+   * @param  mul   Brightness multiplier, 256 = unchanged.
+   */
+  void overlaySprites(uint16_t *dst, int16_t row, uint16_t mul);
+
+  /**
+   * @brief   Get the size of one packed framebuffer for the current flags.
+   * @return  uint32_t  Size in bytes, or 0 if not a line buffer mode.
+   */
+  uint32_t packedBytes(void) const;
+
+  /**
+   * @brief   Get the framebuffer row shown on a scanline, without any
+   *          raster program.
+   * @param   line   Scanline (0 to videoSpec[mode].scanlines-1).
+   * @param   field  0 = odd field, 1 = even.
+   * @return  int16_t  Framebuffer row, 0 to HEIGHT-1, or -1 if the line
+   *                   is blank (outside the rows set by setRowHeight()).
+   */
+  int16_t scanlineRow(uint16_t line, uint8_t field);
+
+  /**
+   * @brief  Apply DAC pre-emphasis to a run of DAC values, in place.
+   * @param  dst   DAC values.
+   * @param  n     Number of values.
+   * @param  prev  DAC value preceding dst[0] in the output.
+   */
+  void emphasize(uint16_t *dst, int16_t n, uint16_t prev);
+
+  /**
+   * @brief  Build the brightness table for the current levels and gamma,
+   *         converting the running display's 16-bit framebuffer
+   *         contents to match.
+   * @return bool  true on success, false if out of memory.
+   */
+  boolean rebuildLUT(void);
+
+  /**
+   * @brief  Convert 16-bit framebuffer(s), if any, from one brightness
+   *         table to another, by nearest DAC value.
+   * @param  from  Table the pixels were drawn with, 256 entries.
+   * @param  to    New table, 256 entries.
+   */
+  void convertLevels(const uint16_t *from, const uint16_t *to);
+
+  /**
+   * @brief  Initialize the sync, blank and black levels of a row.
+   * @param  row  Framebuffer row or line buffer, rowPixelClocks words.
+   */
+  void initRow(uint16_t *row);
+
+  /**
+   * @brief  Store one pixel in unrotated framebuffer coordinates, in the
+   *         framebuffer's native format. No clipping is performed.
+   * @param  x     Column, 0 to WIDTH-1.
+   * @param  y     Row, 0 to HEIGHT-1.
+   * @param  gray  Brightness, 0 (black) to 255 (white).
+   */
+  void writeNative(int16_t x, int16_t y, uint8_t gray);
+
+  /**
+   * @brief  Store one pixel given in rotated (GFX) coordinates. No
+   *         clipping is performed. There's one instance per rotation;
+   *         setRotation() points pixelWriter at the current one.
+   * @param  x     Column, 0 to width()-1.
+   * @param  y     Row, 0 to height()-1.
+   * @param  gray  Brightness, 0 (black) to 255 (white).
+   */
+  template <uint8_t r> void rotatedPixel(int16_t x, int16_t y, uint8_t gray);
+
+  /// Pointer to one of the rotatedPixel() instances.
+  typedef void (Adafruit_CompositeVideo::*PixelWriter)(int16_t, int16_t,
+                                                       uint8_t);
+
+  /**
+   * @brief  Fill a rectangle in unrotated framebuffer coordinates.
+   *         No clipping is performed.
+   * @param  x     Left edge, 0 to WIDTH-1.
+   * @param  y     Top edge, 0 to HEIGHT-1.
+   * @param  w     Width, 1 to WIDTH-x.
+   * @param  h     Height, 1 to HEIGHT-y.
+   * @param  gray  Brightness, 0 (black) to 255 (white).
+   */
+  void fillNative(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t gray);
+
+  /**
+   * @brief  Convert 8-bit grayscale brightness to a DAC value.
+   * @param  gray  Brightness, 0 (black) to 255 (white).
+   * @return uint16_t  DAC value for frameBuffer[].
+   */
+  static uint16_t grayToDAC(uint8_t gray);
+
+  const uint8_t mode;                    ///< Video mode
+  uint8_t flags;                         ///< Option flags passed to begin()
+  uint8_t timer;                         ///< COMPOSITE_TC5, etc.
+  uint8_t clockGen;                      ///< GCLK generator for timer
+  uint32_t clockHz;                      ///< Frequency of clockGen
+  PixelWriter pixelWriter;               ///< rotatedPixel<rotation>
+  Adafruit_ZeroDMA dma;                  ///< SAMD DMA object
+  DmacDescriptor *descriptor;            ///< DMA descriptor list
+  uint16_t numDescriptors;               ///< Descriptors in list
+  uint32_t allocated;                    ///< Bytes allocated by begin()
+  boolean primed;                        ///< Dummy descriptor added to DMA
+  uint16_t *frameBuffer;                 ///< Pixel data drawn to (back buf)
+  uint16_t *frontBuffer;                 ///< Pixel data being shown by DMA
+  uint8_t *packedBuffer;                 ///< Packed pixels drawn to
+  uint8_t *volatile packedFront;         ///< Packed pixels being shown
+  void (*vBlankCallback)(uint8_t field); ///< User vertical blank function
+  volatile uint32_t fieldCount;          ///< Fields output since begin()
+  volatile uint16_t scanline;            ///< Packed modes: lines output
+  int16_t lineRow[2];                    ///< Packed: row in each line buf
+  volatile boolean swapPending;          ///< Swap buffers at end of field
+  boolean swapCopy;                      ///< and copy to new back buffer
+  volatile int16_t scrollX;              ///< Requested scroll position,
+  volatile int16_t scrollY;              ///< applied at end of field
+  int16_t viewX;                         ///< Scroll position being shown
+  int16_t viewY;                         ///< (ditto)
+  const CompositeRasterLine *raster;     ///< Raster program being shown
+  const CompositeRasterLine *rasterNext; ///< Requested raster program
+  volatile boolean scrollPending;        ///< Scroll at end of field
+  uint8_t lineField;                     ///< Packed: field being expanded
+  uint8_t rowLines;                      ///< Scanlines per row, 0 = spread
+  int16_t rowTop;                        ///< Blank scanlines above row 0
+  uint8_t rowLinesNext;                  ///< Requested setRowHeight(),
+  int16_t rowTopNext;                    ///< applied at end of field
+  uint8_t emphasis;                      ///< Pre-emphasis, 16ths of step
+  DmacDescriptor *vsyncChain;            ///< Vsync descriptors, if in RAM
+  uint16_t *vsyncPool;                   ///< Vsync halflines, if in RAM
+  uint16_t vsyncDescs;                   ///< Descriptors in vsyncChain
+  CompositeStats stats;                  ///< getStats() counters
+  uint32_t fieldMicros;                  ///< Duration of one field, uS
+  uint32_t lastFieldMicros;              ///< micros() at last field end
+
+  CompositeSprite sprite[COMPOSITE_SPRITES];     ///< Sprites being shown
+  CompositeSprite spriteNext[COMPOSITE_SPRITES]; ///< Requested sprites,
+  volatile boolean spritePending;                ///< applied at end of field
 };
 
 /**
  * @brief  Class for generating 40x24 pixel grayscale NTSC video, using
-           Adafruit_CompositeVideo.
+           Adafruit_CompositeVideo. Uses about 9.4K of RAM (see begin()).
  */
 class Adafruit_NTSC40x24 : public Adafruit_CompositeVideo {
 public:
@@ -69,33 +868,174 @@ public:
    * @brief Construct a new Adafruit_NTSC40x24 object.
    */
   Adafruit_NTSC40x24();
+};
 
+/**
+ * @brief  Class for generating 80x24 pixel grayscale NTSC video, using
+           Adafruit_CompositeVideo. Pixel clock is twice that of 40x24,
+           so horizontal detail is a bit softer (DAC settling time). Uses
+           about 11.9K of RAM (8.4K if COMPOSITE_COMPACT).
+ */
+class Adafruit_NTSC80x24 : public Adafruit_CompositeVideo {
+public:
   /**
-   * @brief  Call to begin NTSC video output.
-   * @return bool  true on success, false on failure (allocation error).
+   * @brief Construct a new Adafruit_NTSC80x24 object.
    */
-  boolean begin(void);
+  Adafruit_NTSC80x24();
+};
 
+/**
+ * @brief  Class for generating 80x48 pixel grayscale NTSC video, using
+           Adafruit_CompositeVideo. Same timing as 80x24, with rows
+           alternately 5 and 4 scanlines tall. Uses about 16.8K of RAM
+           (13.3K if COMPOSITE_COMPACT).
+ */
+class Adafruit_NTSC80x48 : public Adafruit_CompositeVideo {
+public:
   /**
-   * @brief  Clear framebuffer; set all pixels to 0 (black).
+   * @brief Construct a new Adafruit_NTSC80x48 object.
    */
-  void clear(void);
+  Adafruit_NTSC80x48();
+};
 
+/**
+ * @brief  Class for generating 40x25 pixel grayscale PAL (50 Hz) video,
+           using Adafruit_CompositeVideo. Rows are 10 scanlines tall.
+           Uses about 10.5K of RAM (6.4K if COMPOSITE_COMPACT).
+ */
+class Adafruit_PAL40x25 : public Adafruit_CompositeVideo {
+public:
   /**
-   * @brief  Set current field number, used in kludgey vertical blank
-   *         synchronization. Will be deprecated in future when double-
-   *         buffering is handled.
-   * @param  value  Typically 0 to indicate nonsense field number,
-   *                then getBlank() is used to poll for a specific field.
+   * @brief Construct a new Adafruit_PAL40x25 object.
    */
-  void setBlank(uint8_t value);
+  Adafruit_PAL40x25();
+};
 
+/**
+ * @brief  Class for generating 40x48 pixel grayscale NTSC video, using
+           Adafruit_CompositeVideo. Same timing as 40x24, with rows
+           alternately 5 and 4 scanlines tall; with COMPOSITE_INTERLACE,
+           each row is instead 9 lines of the full interlaced frame.
+           Uses about 11.8K of RAM (8.3K if COMPOSITE_COMPACT).
+ */
+class Adafruit_NTSC40x48 : public Adafruit_CompositeVideo {
+public:
   /**
-   * @brief   Get current NTSC field number. Will be deprecated in future
-   *          when double-buffering is handled.
-   * @return  uint8_t  1 if odd-numbered field, 2 if even-numbered.
+   * @brief Construct a new Adafruit_NTSC40x48 object.
    */
-  uint8_t getBlank(void);
+  Adafruit_NTSC40x48();
+};
+
+#if defined(__SAMD51__)
+/**
+ * @brief  Class for generating 160x96 pixel grayscale NTSC video, using
+           Adafruit_CompositeVideo. SAMD51 only, and EXPERIMENTAL: the
+           3.2 MHz pixel clock is about 3X the DAC's rated 1 MSPS, so
+           expect soft horizontal detail (or worse) until this has been
+           checked on real hardware. Uses about 46K of RAM, so consider
+           COMPOSITE_PACKED8 (about 16K) or COMPOSITE_PACKED4.
+ */
+class Adafruit_NTSC160x96 : public Adafruit_CompositeVideo {
+public:
+  /**
+   * @brief Construct a new Adafruit_NTSC160x96 object.
+   */
+  Adafruit_NTSC160x96();
+};
+#endif
+
+/**
+ * @brief  Offscreen 8-bit grayscale canvas that remembers which area has
+ *         been drawn to since the last flush(), so only that rectangle
+ *         is converted into the display's framebuffer. Useful for screens
+ *         where little changes from one frame to the next.
+ */
+class Adafruit_CompositeCanvas : public GFXcanvas8 {
+public:
+  /**
+   * @brief  Construct a new Adafruit_CompositeCanvas object. The whole
+   *         canvas starts out dirty, so the first flush() copies it all.
+   * @param  w  Canvas width in pixels.
+   * @param  h  Canvas height in pixels.
+   */
+  Adafruit_CompositeCanvas(uint16_t w, uint16_t h);
+
+  /**
+   * @brief  Pixel-drawing function for Adafruit_GFX, marks pixel dirty.
+   * @param  x      Pixel column.
+   * @param  y      Pixel row.
+   * @param  color  Pixel brightness, 0 (black) to 255 (white).
+   */
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+
+  /**
+   * @brief  Fill a rectangle, marks it dirty.
+   * @param  x      Left edge.
+   * @param  y      Top edge.
+   * @param  w      Width in pixels.
+   * @param  h      Height in pixels.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+  /**
+   * @brief  Fill the whole canvas, marks it all dirty.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void fillScreen(uint16_t color);
+
+  /**
+   * @brief  Draw a horizontal line, marks it dirty.
+   * @param  x      Left end.
+   * @param  y      Row.
+   * @param  w      Length in pixels.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+
+  /**
+   * @brief  Draw a vertical line, marks it dirty.
+   * @param  x      Column.
+   * @param  y      Top end.
+   * @param  h      Length in pixels.
+   * @param  color  Brightness, 0 (black) to 255 (white).
+   */
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+
+  /**
+   * @brief  Add a rectangle to the dirty area, for code that writes to
+   *         getBuffer() directly. Coordinates are affected by rotation,
+   *         same as drawing functions. Clipped to the canvas.
+   * @param  x  Left edge.
+   * @param  y  Top edge.
+   * @param  w  Width in pixels.
+   * @param  h  Height in pixels.
+   */
+  void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  /**
+   * @brief   Check whether anything has been drawn since the last flush().
+   * @return  bool  true if flush() has anything to copy.
+   */
+  boolean isDirty(void) const { return dirtyX1 >= dirtyX0; }
+
+  /**
+   * @brief  Copy the dirty area (if any) to a display, then mark the
+   *         canvas clean. The canvas is copied unrotated, as with
+   *         drawGrayscaleBitmap(). To avoid tearing, call this right
+   *         after waitForVBlank(), or draw to a double-buffered display
+   *         and swapBuffers(true) afterward.
+   * @param  display  Display to copy to.
+   * @param  x        Display column for the canvas' left edge.
+   * @param  y        Display row for the canvas' top edge.
+   */
+  void flush(Adafruit_CompositeVideo &display, int16_t x = 0, int16_t y = 0);
+
+protected:
+  int16_t dirtyX0; ///< Dirty area left edge, unrotated (> dirtyX1 if clean)
+  int16_t dirtyY0; ///< Dirty area top edge, unrotated
+  int16_t dirtyX1; ///< Dirty area right edge (inclusive), unrotated
+  int16_t dirtyY1; ///< Dirty area bottom edge (inclusive), unrotated
 };
 
 #endif // _ADAFRUIT_COMPOSITEVIDEO_H_
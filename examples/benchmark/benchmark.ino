@@ -0,0 +1,111 @@
+// Benchmark for the Adafruit_CompositeVideo library. Measures CPU cycles
+// spent in common drawing calls on real hardware (while video is running,
+// so DMA interrupt overhead is included), and how much of each video field
+// is left over for the sketch after a typical redraw. Results go to Serial.
+// Requires latest Adafruit_GFX and Adafruit_ZeroDMA libraries.
+// Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_CompositeVideo.h>
+
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
+GFXcanvas8         canvas(40, 24); // Source image for drawGrayscaleBitmap()
+
+// SysTick counts CPU cycles down from LOAD to 0 once per millisecond and
+// the core's SysTick interrupt counts those wraps in millis(). Combining
+// the two gives a cycle counter that's good for about 89 seconds at 48 MHz.
+uint32_t cycles(void) {
+  __disable_irq();
+  uint32_t ms = millis(), val = SysTick->VAL;
+  if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) { // Wrapped, not yet counted
+    ms++;
+    val = SysTick->VAL;
+  }
+  __enable_irq();
+  uint32_t load = SysTick->LOAD + 1;
+  return ms * load + (load - 1 - val);
+}
+
+// Run 'code' n times, print average cycles per run minus loop overhead
+#define BENCH(label, n, code) {                            \
+  uint32_t t = cycles();                                   \
+  for(uint16_t i=0; i<n; i++) { code; }                    \
+  t = cycles() - t;                                        \
+  report(label, t / n);                                    \
+}
+
+uint32_t overhead = 0; // Cycles per empty BENCH loop iteration
+
+void report(const char *label, uint32_t c) {
+  c = (c > overhead) ? c - overhead : 0;
+  Serial.print(label);
+  Serial.print(": ");
+  Serial.print(c);
+  Serial.print(" cycles (");
+  Serial.print((float)c * 1000000.0 / F_CPU, 1);
+  Serial.println(" uS)");
+}
+
+volatile uint16_t sink; // Keeps the empty loop from being optimized away
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+  if(!display.begin()) for(;;);   // Initialize display; halt on failure
+
+  for(int16_t y=0; y<canvas.height(); y++) { // Gradient test image
+    for(int16_t x=0; x<canvas.width(); x++) {
+      canvas.drawPixel(x, y, (x * 255) / (canvas.width() - 1));
+    }
+  }
+}
+
+void loop() {
+  int16_t w = display.width(), h = display.height();
+
+  overhead = 0;
+  {
+    uint32_t t = cycles();
+    for(uint16_t i=0; i<1000; i++) sink = i;
+    overhead = (cycles() - t) / 1000;
+  }
+
+  BENCH("drawPixel", 1000, display.drawPixel(i % w, (i / w) % h, i));
+  BENCH("fillScreen", 20, display.fillScreen(i));
+  BENCH("drawGrayscaleBitmap", 20,
+    display.drawGrayscaleBitmap(0, 0, canvas.getBuffer(), w, h));
+  BENCH("clear", 20, display.clear());
+  BENCH("print", 20, display.setCursor(0, 0); display.print("Hello World"));
+
+  // Field time left over after a typical redraw: sync to the start of a
+  // field, draw, then see how long remains until the next one begins.
+  uint32_t field, work;
+  display.waitForVBlank();
+  field = cycles();
+  display.waitForVBlank();
+  field = cycles() - field;
+  work  = cycles();
+  display.drawGrayscaleBitmap(0, 0, canvas.getBuffer(), w, h);
+  display.setCursor(4, 4);
+  display.print(millis());
+  work  = cycles() - work;
+  Serial.print("Field: ");
+  Serial.print(field);
+  Serial.print(" cycles, redraw: ");
+  Serial.print(work);
+  Serial.print(", left over: ");
+  Serial.print((work < field) ? field - work : 0);
+  Serial.print(" (");
+  Serial.print((work < field) ? (float)(field - work) * 100.0 / field : 0.0,
+    1);
+  Serial.println("%)");
+
+  CompositeStats s = display.getStats();
+  Serial.print("Callback max: ");
+  Serial.print(s.callbackMax);
+  Serial.print(" uS, missed fields: ");
+  Serial.println(s.missedFields);
+  Serial.println();
+
+  delay(5000);
+}
@@ -0,0 +1,32 @@
+// Dirty-rectangle canvas example for the Adafruit_CompositeVideo library.
+// Draws into an offscreen canvas, and only the parts that changed since
+// the last frame are converted to the video framebuffer.
+// Written for Adafruit Circuit Playground Express (not 'classic'),
+// but can also work on Feather M0, Arduino Zero or similar boards.
+// Requires latest Adafruit_GFX and Adafruit_ZeroDMA libraries.
+// Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_CompositeVideo.h>
+
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
+Adafruit_CompositeCanvas canvas(40, 24);
+
+void setup() {
+  if(!display.begin()) for(;;); // Halt on failure
+  for(uint8_t y=0; y<canvas.height(); y++)
+    canvas.drawFastHLine(0, y, canvas.width(), y * 5); // Gradient backdrop
+}
+
+void loop() {
+  // Seconds counter; only the digits' rectangle is marked dirty
+  canvas.fillRect(8, 8, 24, 8, 0);
+  canvas.setCursor(8, 8);
+  canvas.setTextColor(255);
+  canvas.print((millis() / 1000) % 1000);
+
+  // Copy the changed area during vertical blank, so there's no tearing.
+  // On most frames that's a few hundred pixels rather than all 960.
+  display.waitForVBlank();
+  canvas.flush(display);
+}
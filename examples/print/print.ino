@@ -10,7 +10,7 @@
 
 #define PIN A8 // Light sensor on Circuit Playground Express
 
-Adafruit_NTSC40x24 display; // NTSC 40x24 currently the only supported type
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
 
 void setup() {
   if(!display.begin()) for(;;);   // Initialize display; halt on failure
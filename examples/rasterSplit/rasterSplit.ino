@@ -0,0 +1,52 @@
+// Raster program example for the Adafruit_CompositeVideo library.
+// The top of the screen scrolls vertically through a tall gradient,
+// while the bottom rows stay put as a status bar -- the DMA does all the
+// work of picking rows, nothing is redrawn from frame to frame.
+// Written for Adafruit Circuit Playground Express (not 'classic'),
+// but can also work on Feather M0, Arduino Zero or similar boards.
+// Requires latest Adafruit_GFX and Adafruit_ZeroDMA libraries.
+// Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_CompositeVideo.h>
+
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
+
+#define STATUS_ROWS 4 // Framebuffer rows at bottom used for status bar
+
+CompositeRasterLine *program;
+uint16_t lines, statusLines;
+int16_t scroll = 0;
+
+void setup() {
+  if(!display.begin()) for(;;); // Halt on failure
+  int16_t h = display.height() - STATUS_ROWS;
+  for(int16_t y=0; y<h; y++)
+    display.drawFastHLine(0, y, display.width(), y * 255 / h); // Gradient
+  display.fillRect(0, h, display.width(), STATUS_ROWS, 128); // Status bar
+
+  lines = display.getScanlines();
+  statusLines = lines * STATUS_ROWS / display.height();
+  program = (CompositeRasterLine *)malloc(lines * sizeof *program);
+  if(!program) for(;;);
+  for(uint16_t i=0; i<lines; i++) {
+    program[i].scrollX    = 0;
+    program[i].brightness = 255;
+  }
+}
+
+void loop() {
+  // Upper area: rows wrap around within the gradient, 'scroll' rows down
+  int16_t h = display.height() - STATUS_ROWS;
+  uint16_t upper = lines - statusLines;
+  for(uint16_t i=0; i<upper; i++)
+    program[i].row = (i * h / upper + scroll) % h;
+  // Status bar: always the same framebuffer rows
+  for(uint16_t i=upper; i<lines; i++)
+    program[i].row = h + (i - upper) * STATUS_ROWS / statusLines;
+
+  display.setRasterProgram(program); // Picked up at next vertical blank
+  display.waitForVBlank();
+  delay(50);
+  if(++scroll >= h) scroll = 0;
+}
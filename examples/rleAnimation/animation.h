@@ -0,0 +1,109 @@
+// Generated by rle_encode.py
+
+const uint8_t animation[] PROGMEM = {
+    0x43, 0x56, 0x49, 0x44, 0x01, 0x80, 0x28, 0x00, 0x18, 0x00, 0x18, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xBF, 0x00, 0xBF, 0x00, 0xBF, 0x00, 0xBF, 0x00,
+    0xBF, 0x00, 0xBF, 0x00, 0xBF, 0x00, 0xA3, 0x00, 0xC0, 0xFF, 0xA4, 0x00,
+    0x84, 0xFF, 0xA1, 0x00, 0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0xA0, 0x00, 0x83,
+    0xFF, 0x82, 0xA0, 0x9F, 0x00, 0x83, 0xFF, 0x84, 0xA0, 0x9F, 0x00, 0xC1,
+    0xFF, 0xFF, 0x84, 0xA0, 0xA0, 0x00, 0xC0, 0xFF, 0x85, 0xA0, 0xA1, 0x00,
+    0x84, 0xA0, 0xA0, 0x00, 0x83, 0x40, 0xC0, 0xA0, 0xBF, 0x40, 0xBF, 0x40,
+    0x9A, 0x40, 0x7F, 0x7F, 0x6B, 0xC1, 0xFF, 0xFF, 0x23, 0x85, 0xFF, 0x21,
+    0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0x1F, 0x84, 0xFF, 0x82, 0xA0, 0x1F, 0x83,
+    0xFF, 0x83, 0xA0, 0x22, 0x84, 0xA0, 0x1F, 0xC0, 0x00, 0x00, 0x84, 0xA0,
+    0x1F, 0x82, 0x00, 0x84, 0xA0, 0xBF, 0x00, 0x08, 0xBF, 0x00, 0x12, 0xBF,
+    0x40, 0x5B, 0x7F, 0x7F, 0x1B, 0x84, 0xFF, 0x21, 0x85, 0xFF, 0xC0, 0xA0,
+    0x20, 0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0x1F, 0xC0, 0x00, 0x03, 0x83, 0xA0,
+    0x1E, 0xC0, 0x00, 0x02, 0x83, 0xA0, 0x1E, 0xC1, 0x00, 0x00, 0x01, 0x84,
+    0xA0, 0x1E, 0x82, 0x00, 0x84, 0xA0, 0x1F, 0xBF, 0x00, 0x11, 0xBF, 0x00,
+    0x7F, 0x7C, 0x7F, 0x26, 0x83, 0xFF, 0x22, 0x85, 0xFF, 0x20, 0x85, 0xFF,
+    0xC1, 0xA0, 0xA0, 0x1E, 0xC0, 0x00, 0x03, 0xC0, 0xFF, 0x82, 0xA0, 0x1D,
+    0xC1, 0x00, 0x00, 0x04, 0x82, 0xA0, 0x1D, 0xC1, 0x00, 0x00, 0x04, 0x82,
+    0xA0, 0x1D, 0x82, 0x00, 0x04, 0xC0, 0xA0, 0x1E, 0x83, 0x00, 0x02, 0xC0,
+    0xA0, 0x1F, 0xBF, 0x00, 0x7F, 0x7F, 0x7F, 0x1C, 0x5A, 0x82, 0xFF, 0x22,
+    0x85, 0xFF, 0x1F, 0xC1, 0x00, 0x00, 0x01, 0x82, 0xFF, 0xC1, 0xA0, 0xA0,
+    0x1D, 0xC1, 0x00, 0x00, 0x03, 0xC0, 0xFF, 0x82, 0xA0, 0x1C, 0x82, 0x00,
+    0x02, 0xC0, 0xFF, 0x00, 0x82, 0xA0, 0x1C, 0x83, 0x00, 0x00, 0xC0, 0xFF,
+    0x01, 0x82, 0xA0, 0x1C, 0x83, 0x00, 0xC0, 0xFF, 0x02, 0xC1, 0xA0, 0xA0,
+    0x1D, 0x84, 0x00, 0x02, 0xC0, 0xA0, 0x1F, 0xBF, 0x00, 0x7F, 0x7F, 0x7F,
+    0x69, 0x35, 0x83, 0xFF, 0x20, 0xC1, 0x00, 0x00, 0x00, 0x83, 0xFF, 0xC0,
+    0xA0, 0x1D, 0x82, 0x00, 0x02, 0xC1, 0xFF, 0xFF, 0x82, 0xA0, 0x1C, 0x82,
+    0x00, 0x01, 0xC1, 0xFF, 0xFF, 0x83, 0xA0, 0x1B, 0x83, 0x00, 0x00, 0xC1,
+    0xFF, 0xFF, 0x00, 0x83, 0xA0, 0x1B, 0x83, 0x00, 0xC1, 0xFF, 0xFF, 0x01,
+    0x83, 0xA0, 0x1C, 0x83, 0x00, 0x02, 0x82, 0xA0, 0x1D, 0x84, 0x00, 0x00,
+    0x82, 0xA0, 0x1F, 0xBF, 0x00, 0x7F, 0x7F, 0x7F, 0x7F, 0x0D, 0x35, 0x82,
+    0x00, 0x00, 0x84, 0xFF, 0x1D, 0x83, 0x00, 0x00, 0x83, 0xFF, 0xC0, 0xA0,
+    0x1C, 0x83, 0x00, 0x00, 0x83, 0xFF, 0x82, 0xA0, 0x1B, 0x83, 0x00, 0x83,
+    0xFF, 0x83, 0xA0, 0x1B, 0x83, 0x00, 0x82, 0xFF, 0x00, 0x83, 0xA0, 0x1B,
+    0x84, 0x00, 0xC0, 0xFF, 0x01, 0x82, 0xA0, 0x1D, 0x83, 0x00, 0x01, 0x83,
+    0xA0, 0x1E, 0xBF, 0x00, 0x7F, 0x7F, 0x7F, 0x7F, 0x31, 0x38, 0x84, 0x00,
+    0x00, 0x82, 0xFF, 0x1E, 0x83, 0x00, 0x00, 0x83, 0xFF, 0xC0, 0xA0, 0x1C,
+    0x83, 0x00, 0x00, 0x83, 0xFF, 0x82, 0xA0, 0x1B, 0x83, 0x00, 0x83, 0xFF,
+    0x83, 0xA0, 0x1B, 0x83, 0x00, 0x82, 0xFF, 0x00, 0x83, 0xA0, 0x1C, 0x82,
+    0x00, 0xC1, 0xFF, 0xFF, 0x00, 0x84, 0xA0, 0x1C, 0x83, 0x00, 0x01, 0x83,
+    0xA0, 0x22, 0x83, 0xA0, 0x7F, 0x7F, 0x7F, 0x7F, 0x65, 0x3D, 0xAB, 0x00,
+    0x82, 0xFF, 0x1E, 0x84, 0x00, 0x84, 0xFF, 0xC0, 0xA0, 0x1C, 0x83, 0x00,
+    0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0x1C, 0x83, 0x00, 0x83, 0xFF, 0x83, 0xA0,
+    0x1B, 0x83, 0x00, 0x82, 0xFF, 0x00, 0x83, 0xA0, 0x1C, 0x82, 0x00, 0xC1,
+    0xFF, 0xFF, 0x00, 0x83, 0xA0, 0x1E, 0x82, 0x00, 0x00, 0x84, 0xA0, 0x22,
+    0x83, 0xA0, 0x7F, 0x7F, 0x7F, 0x7F, 0x39, 0x69, 0xBF, 0x00, 0x0D, 0x84,
+    0x00, 0x83, 0xFF, 0x1E, 0x83, 0x00, 0x84, 0xFF, 0xC0, 0xA0, 0x1D, 0x82,
+    0x00, 0x84, 0xFF, 0x82, 0xA0, 0x1C, 0x82, 0x00, 0x83, 0xFF, 0x83, 0xA0,
+    0x1D, 0xC1, 0x00, 0x00, 0x82, 0xFF, 0x00, 0x83, 0xA0, 0x1E, 0xC2, 0x00,
+    0xFF, 0xFF, 0x00, 0x84, 0xA0, 0x20, 0x85, 0xA0, 0x22, 0x83, 0xA0, 0x7F,
+    0x7F, 0x7F, 0x66, 0x7F, 0x3C, 0xBF, 0x00, 0x0D, 0xAB, 0x00, 0x84, 0xFF,
+    0x1E, 0x82, 0x00, 0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0x1D, 0x82, 0x00, 0x83,
+    0xFF, 0x00, 0xC1, 0xA0, 0xA0, 0x1E, 0xC0, 0x00, 0x83, 0xFF, 0x00, 0x82,
+    0xA0, 0x1F, 0xC2, 0x00, 0xFF, 0xFF, 0x00, 0x83, 0xA0, 0x20, 0xC0, 0xFF,
+    0x85, 0xA0, 0x21, 0x84, 0xA0, 0x7F, 0x7F, 0x7F, 0x13, 0x7F, 0x7F, 0x36,
+    0xBF, 0x00, 0x0E, 0x83, 0x00, 0xC1, 0xFF, 0xFF, 0xA3, 0x00, 0x00, 0x84,
+    0xFF, 0x1F, 0xC0, 0x00, 0x00, 0x84, 0xFF, 0xC0, 0xA0, 0x1F, 0xC0, 0x00,
+    0x84, 0xFF, 0x00, 0xC1, 0xA0, 0xA0, 0x1F, 0x83, 0xFF, 0x00, 0x82, 0xA0,
+    0x1F, 0x82, 0xFF, 0x84, 0xA0, 0x20, 0xC0, 0xFF, 0x84, 0xA0, 0x21, 0x84,
+    0xA0, 0x7F, 0x7F, 0x1A, 0x7F, 0x7F, 0x7F, 0x09, 0xBF, 0x00, 0x0C, 0xAB,
+    0x00, 0x00, 0xA4, 0x00, 0x01, 0x82, 0xFF, 0xA1, 0x00, 0x01, 0x82, 0xFF,
+    0x23, 0x82, 0xFF, 0x01, 0xC0, 0xA0, 0x1F, 0x83, 0xFF, 0x01, 0x82, 0xA0,
+    0x1F, 0xC1, 0xFF, 0xFF, 0x84, 0xA0, 0x20, 0xC0, 0xFF, 0x85, 0xA0, 0x21,
+    0x84, 0xA0, 0x7F, 0x21, 0x7F, 0x7F, 0x7F, 0x09, 0xC1, 0xFF, 0xFF, 0x23,
+    0x85, 0xFF, 0x20, 0x85, 0xFF, 0xC0, 0xA0, 0x20, 0x84, 0xFF, 0x82, 0xA0,
+    0x1F, 0x83, 0xFF, 0x83, 0xA0, 0x1F, 0x82, 0xFF, 0x84, 0xA0, 0x21, 0x84,
+    0xA0, 0xA1, 0x00, 0x84, 0xA0, 0xBF, 0x00, 0x0A, 0xAF, 0x00, 0x7F, 0x1F,
+    0x7F, 0x7F, 0x36, 0x84, 0xFF, 0x21, 0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0x20,
+    0x83, 0xFF, 0x82, 0xA0, 0x1F, 0x83, 0xFF, 0x83, 0xA0, 0xA0, 0x00, 0xC0,
+    0xFF, 0x00, 0x84, 0xA0, 0xA0, 0x00, 0xC0, 0xFF, 0x85, 0xA0, 0xA1, 0x00,
+    0x84, 0xA0, 0xBF, 0x00, 0x0B, 0xBF, 0x00, 0x7F, 0x7F, 0x07, 0x7F, 0x3C,
+    0x83, 0xFF, 0x22, 0x84, 0xFF, 0xC0, 0xA0, 0x20, 0x84, 0xFF, 0x82, 0xA0,
+    0x1F, 0x83, 0xFF, 0x83, 0xA0, 0x9F, 0x00, 0x82, 0xFF, 0x84, 0xA0, 0x9F,
+    0x00, 0xC1, 0xFF, 0xFF, 0x85, 0xA0, 0xA0, 0x00, 0x85, 0xA0, 0xA2, 0x00,
+    0x83, 0xA0, 0xBF, 0x00, 0x0D, 0xBF, 0x00, 0x7F, 0x7F, 0x58, 0x69, 0x82,
+    0xFF, 0x23, 0x84, 0xFF, 0xC0, 0xA0, 0x20, 0x84, 0xFF, 0xC1, 0xA0, 0xA0,
+    0xA0, 0x00, 0x83, 0xFF, 0x83, 0xA0, 0x9F, 0x00, 0x82, 0xFF, 0x84, 0xA0,
+    0x9F, 0x00, 0xC1, 0xFF, 0xFF, 0x84, 0xA0, 0xA1, 0x00, 0x85, 0xA0, 0xA2,
+    0x00, 0x83, 0xA0, 0xBF, 0x00, 0x0E, 0xBF, 0x00, 0x7F, 0x7F, 0x7F, 0x2A,
+    0x3D, 0x83, 0xFF, 0x22, 0x84, 0xFF, 0xC0, 0xA0, 0xA0, 0x00, 0x84, 0xFF,
+    0x82, 0xA0, 0x9F, 0x00, 0x83, 0xFF, 0x83, 0xA0, 0x9F, 0x00, 0x82, 0xFF,
+    0x84, 0xA0, 0x9F, 0x00, 0xC1, 0xFF, 0xFF, 0x85, 0xA0, 0xA0, 0x00, 0x85,
+    0xA0, 0xA2, 0x00, 0x83, 0xA0, 0xBF, 0x00, 0x7F, 0x7F, 0x7F, 0x7F, 0x25,
+    0x38, 0x85, 0xFF, 0xA1, 0x00, 0x84, 0xFF, 0xC0, 0xA0, 0xA0, 0x00, 0x84,
+    0xFF, 0x82, 0xA0, 0x9F, 0x00, 0x83, 0xFF, 0x83, 0xA0, 0x9F, 0x00, 0x82,
+    0xFF, 0x84, 0xA0, 0xA0, 0x00, 0xC0, 0xFF, 0x84, 0xA0, 0xA1, 0x00, 0x85,
+    0xA0, 0xBF, 0x00, 0x7F, 0x7F, 0x7F, 0x7F, 0x50, 0x35, 0x83, 0xFF, 0xA2,
+    0x00, 0x84, 0xFF, 0xC0, 0xA0, 0xA0, 0x00, 0x84, 0xFF, 0x82, 0xA0, 0x9F,
+    0x00, 0x83, 0xFF, 0x83, 0xA0, 0x9F, 0x00, 0x82, 0xFF, 0x84, 0xA0, 0x9F,
+    0x00, 0xC1, 0xFF, 0xFF, 0x85, 0xA0, 0xA0, 0x00, 0x85, 0xA0, 0xA2, 0x00,
+    0x83, 0xA0, 0x7F, 0x7F, 0x7F, 0x7F, 0x6D, 0x35, 0xA4, 0x00, 0x82, 0xFF,
+    0xA2, 0x00, 0x85, 0xFF, 0xA1, 0x00, 0x84, 0xFF, 0xC1, 0xA0, 0xA0, 0x9F,
+    0x00, 0x84, 0xFF, 0x82, 0xA0, 0x9F, 0x00, 0x83, 0xFF, 0x83, 0xA0, 0xA0,
+    0x00, 0xC1, 0xFF, 0xFF, 0x84, 0xA0, 0xA0, 0x00, 0xC0, 0xFF, 0x84, 0xA0,
+    0xA2, 0x00, 0x83, 0xA0, 0x7F, 0x7F, 0x7F, 0x7F, 0x49, 0x5A, 0xBF, 0x00,
+    0x0B, 0x83, 0xFF, 0xA2, 0x00, 0x85, 0xFF, 0xA0, 0x00, 0x85, 0xFF, 0xC0,
+    0xA0, 0x00, 0x9F, 0x00, 0x84, 0xFF, 0x82, 0xA0, 0x9F, 0x00, 0x83, 0xFF,
+    0x83, 0xA0, 0x9F, 0x00, 0x82, 0xFF, 0x84, 0xA0, 0xA0, 0x00, 0xC0, 0xFF,
+    0x84, 0xA0, 0x22, 0x83, 0xA0, 0x7F, 0x7F, 0x7F, 0x7C, 0x7F, 0x26, 0xBF,
+    0x00, 0x0D, 0xA6, 0x00, 0x84, 0xFF, 0xA1, 0x00, 0x85, 0xFF, 0x00, 0xA0,
+    0x00, 0x84, 0xFF, 0x01, 0xA0, 0x00, 0x83, 0xFF, 0x03, 0x9F, 0x00, 0x82,
+    0xFF, 0x83, 0xA0, 0xA0, 0x00, 0xC1, 0xFF, 0xFF, 0x84, 0xA0, 0x21, 0x84,
+    0xA0, 0x7F, 0x7F, 0x7F, 0x2E, 0x7F, 0x7F, 0x1B, 0xBF, 0x00, 0x0E, 0xC0,
+    0x00, 0x01, 0xA3, 0x00, 0x85, 0xFF, 0xA1, 0x00, 0x84, 0xFF, 0x01, 0x9F,
+    0x00, 0x84, 0xFF, 0x02, 0x9F, 0x00, 0x83, 0xFF, 0x23, 0x82, 0xFF, 0x84,
+    0xA0, 0x20, 0xC0, 0xFF, 0x84, 0xA0, 0x22, 0x84, 0xA0, 0x7F, 0x7F, 0x37};
@@ -0,0 +1,43 @@
+// Compressed animation example for the Adafruit_CompositeVideo library.
+// Plays a run-length/delta encoded animation from internal flash: each
+// frame stores only the pixels that changed since the last, so this
+// 24-frame loop takes 1.3K rather than 23K. animation.h was made with
+// extras/rle_encode.py from a series of 40x24 images:
+//   python3 rle_encode.py -o animation.h frame*.pgm
+// Written for Adafruit Circuit Playground Express (not 'classic'),
+// but can also work on Feather M0, Arduino Zero or similar boards.
+// Requires latest Adafruit_GFX and Adafruit_ZeroDMA libraries.
+// Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_CompositeVideo.h>
+#include "animation.h"
+
+#define FPS 20
+
+Adafruit_NTSC40x24 display; // Animation is 40x24, other sizes need new data
+
+CompositeStreamHeader header;
+const uint8_t *frame;
+uint16_t frameNum = 0;
+
+void setup() {
+  if(!display.begin()) for(;;); // Initialize display; halt on failure
+  memcpy(&header, animation, sizeof header); // (array might not be aligned)
+  if(!display.checkStream(&header)) {
+    display.print("Bad data");
+    for(;;);
+  }
+  frame = animation + sizeof header;
+}
+
+void loop() {
+  uint32_t t = millis();
+  display.waitForVBlank();              // Draw while nothing's displayed
+  frame = display.drawRLEFrame(frame);
+  if(!frame || (++frameNum >= header.frames)) { // Loop to first frame
+    frame    = animation + sizeof header;
+    frameNum = 0;
+  }
+  while((millis() - t) < (1000 / FPS));
+}
@@ -9,46 +9,38 @@
 #include <Adafruit_CompositeVideo.h>
 #include <Fonts/FreeSerifItalic18pt7b.h>
 
-Adafruit_NTSC40x24 display; // NTSC 40x24 currently the only supported type
-
-// To prevent video "tearing," an offscreen canvas is used for drawing:
-GFXcanvas8 canvas(display.width(), display.height());
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
 
 void setup() {
-  if(!display.begin()) for(;;); // Initialize display; halt on failure
-  canvas.setTextWrap(false);    // Allow text to flow off right edge
-  canvas.setFont(&FreeSerifItalic18pt7b);
+  // To prevent video "tearing," the display is double-buffered:
+  // drawing happens offscreen and swapBuffers() then shows it.
+  if(!display.begin(COMPOSITE_DOUBLEBUFFER)) for(;;); // Halt on failure
+  display.setTextWrap(false);   // Allow text to flow off right edge
+  display.setFont(&FreeSerifItalic18pt7b);
 }
 
 int x = display.width(); // Text horizontal position
 
 void loop() {
-  // DO NOT get too comfortable with this, it's a hack and will be replaced
-  // with a better method in the future!  For now, this polls (waits) until
-  // an odd-numbered field vertical blank is occurring...
-  while(display.getBlank() != 1);
-  display.setBlank(0);
-
-  // During (or near) vertical blanking, copy offscreen canvas to display:
-  display.drawGrayscaleBitmap(0, 0,
-    canvas.getBuffer(), display.width(), display.height());
-
-  // Then draw next frame in the offscreen canvas...
-  for(uint8_t y=0; y<canvas.height(); y++)
-    canvas.drawLine(0, y, canvas.width() - 1, y, y * 5); // Gradient
+  // Draw next frame in the back buffer...
+  for(uint8_t y=0; y<display.height(); y++)
+    display.drawLine(0, y, display.width() - 1, y, y * 5); // Gradient
 
   // Draw text shadow 1 pixel down/right from text
-  canvas.setCursor(x + 1, canvas.height());
-  canvas.setTextColor(0);
-  canvas.print("Hello World");
+  display.setCursor(x + 1, display.height());
+  display.setTextColor(0);
+  display.print("Hello World");
 
   // Draw text on top of shadow
-  canvas.setCursor(x, canvas.height() - 1);
-  canvas.setTextColor(255);
-  canvas.print("Hello World");
+  display.setCursor(x, display.height() - 1);
+  display.setTextColor(255);
+  display.print("Hello World");
+
+  // Then show it. This waits for vertical blank, so it also sets the
+  // animation speed (one frame per NTSC field, or a bit less).
+  display.swapBuffers();
 
   // Move text position one pixel to left.
   // If it's gone entirely off the left side, reset to the far right.
   if(--x < -170) x = display.width();
 }
-
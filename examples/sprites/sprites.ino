@@ -0,0 +1,56 @@
+// Sprite example for the Adafruit_CompositeVideo library.
+// A few 8x8 balls bounce over a background that's drawn only once --
+// sprites are added to each scanline as it's output, so moving one is
+// just a new position, nothing in the framebuffer is erased or redrawn.
+// Sprites need one of the packed or text modes.
+// Written for Adafruit Circuit Playground Express (not 'classic'),
+// but can also work on Feather M0, Arduino Zero or similar boards.
+// Requires latest Adafruit_GFX and Adafruit_ZeroDMA libraries.
+// Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_CompositeVideo.h>
+
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
+
+#define NUM_BALLS 3
+
+uint8_t ball[64];                    // Shaded ball, built in setup()
+const uint8_t ballMask[8] = {        // Round outline, 1 = drawn
+  0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C };
+int16_t x[NUM_BALLS], y[NUM_BALLS], dx[NUM_BALLS], dy[NUM_BALLS];
+
+void setup() {
+  if(!display.begin(COMPOSITE_PACKED8)) for(;;); // Halt on failure
+
+  // Background: diagonal stripes, drawn once
+  for(int16_t i=-display.height(); i<display.width(); i+=6)
+    display.drawLine(i, 0, i + display.height(), display.height(), 96);
+  display.setCursor(4, 4);
+  display.print("Hi!");
+
+  // Brightest toward upper left
+  for(uint8_t j=0; j<8; j++) {
+    for(uint8_t i=0; i<8; i++) ball[j * 8 + i] = 255 - (i + j) * 14;
+  }
+
+  for(uint8_t n=0; n<NUM_BALLS; n++) {
+    x[n]  = n * 10;
+    y[n]  = n * 5;
+    dx[n] = (n & 1) ? -1 : 1;
+    dy[n] = 1;
+    display.setSprite(n, x[n], y[n], ball, ballMask);
+  }
+}
+
+void loop() {
+  for(uint8_t n=0; n<NUM_BALLS; n++) {
+    x[n] += dx[n];
+    y[n] += dy[n];
+    if((x[n] <= 0) || (x[n] >= display.width() - 8))  dx[n] = -dx[n];
+    if((y[n] <= 0) || (y[n] >= display.height() - 8)) dy[n] = -dy[n];
+    display.moveSprite(n, x[n], y[n]); // Takes effect at next vblank
+  }
+  display.waitForVBlank();
+  delay(30);
+}
@@ -0,0 +1,77 @@
+// Streaming example for the Adafruit_CompositeVideo library.
+// Plays ready-made frames from SPI flash: each frame is DMA'd from the
+// flash chip straight into the display's back buffer, so the CPU only
+// starts each transfer and never touches the pixels.
+// The stream (a CompositeStreamHeader, then frames in the back buffer's
+// own format -- see getFrameData()) must already be on the chip, raw, at
+// STREAM_ADDR. This uses 8-bit packed frames (960 bytes each at 40x24).
+// Written for Adafruit Circuit Playground Express (not 'classic'), using
+// its onboard flash, but can also work on Feather M0, Arduino Zero or
+// similar boards with a flash chip on SPI.
+// Requires latest Adafruit_GFX and Adafruit_ZeroDMA libraries.
+// Gator-clip composite video 'tip' to pin A0, 'ring' to GND.
+
+#include <SPI.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_CompositeVideo.h>
+
+#if defined(EXTERNAL_FLASH_USE_SPI) // Board with built-in flash
+#define FLASH_SPI EXTERNAL_FLASH_USE_SPI
+#define FLASH_CS  EXTERNAL_FLASH_USE_CS
+#else
+#define FLASH_SPI SPI
+#define FLASH_CS  10
+#endif
+
+#define STREAM_ADDR 0 // Location of stream on flash chip
+#define FPS         15
+
+Adafruit_NTSC40x24 display; // Also: Adafruit_NTSC40x48, 80x24, 80x48, PAL40x25
+
+CompositeStreamHeader header;
+uint16_t frame = 0;
+
+// Wait for flashRead() to finish and release the chip
+void flashEnd(void) {
+  FLASH_SPI.waitForTransfer();
+  digitalWrite(FLASH_CS, HIGH);
+  FLASH_SPI.endTransaction();
+}
+
+// Start reading from flash into buf. With wait false, this returns once
+// the DMA transfer is underway; call flashEnd() before using buf.
+void flashRead(uint32_t addr, void *buf, uint32_t n, bool wait) {
+  FLASH_SPI.beginTransaction(SPISettings(12000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(FLASH_CS, LOW);
+  FLASH_SPI.transfer(0x03); // Read data command, then 24-bit address
+  FLASH_SPI.transfer(addr >> 16);
+  FLASH_SPI.transfer(addr >> 8);
+  FLASH_SPI.transfer(addr);
+  FLASH_SPI.transfer(NULL, buf, n, wait);
+  if(wait) flashEnd();
+}
+
+void setup() {
+  pinMode(FLASH_CS, OUTPUT);
+  digitalWrite(FLASH_CS, HIGH);
+  FLASH_SPI.begin();
+
+  if(!display.begin(COMPOSITE_PACKED8 | COMPOSITE_DOUBLEBUFFER)) for(;;);
+  flashRead(STREAM_ADDR, &header, sizeof header, true);
+  if(!display.checkStream(&header) || !header.frames) {
+    display.print("No stream");
+    display.swapBuffers();
+    for(;;);
+  }
+}
+
+void loop() {
+  uint32_t t = millis(), n;
+  uint8_t *buf = display.getFrameData(&n);
+  flashRead(STREAM_ADDR + sizeof header + (uint32_t)frame * n, buf, n, false);
+  // CPU is free here while the frame loads
+  flashEnd();
+  display.swapBuffers(false); // Show it at next vblank, no copy back
+  if(++frame >= header.frames) frame = 0;
+  while((millis() - t) < (1000 / FPS));
+}
@@ -0,0 +1,77 @@
+// Host stand-in for Adafruit_ZeroDMA: one channel, whose transfers are
+// carried out by the descriptor-walking DMAC model in sim_core.cpp.
+
+#ifndef _HOST_SIM_ADAFRUIT_ZERODMA_H_
+#define _HOST_SIM_ADAFRUIT_ZERODMA_H_
+
+/// @cond HOST_SIM
+
+#include <Arduino.h>
+
+enum ZeroDMAstatus {
+  DMA_STATUS_OK = 0,
+  DMA_STATUS_ERR_NOT_FOUND,
+  DMA_STATUS_ERR_NOT_INITIALIZED,
+  DMA_STATUS_BUSY
+};
+
+enum dma_beat_size {
+  DMA_BEAT_SIZE_BYTE = 0,
+  DMA_BEAT_SIZE_HWORD,
+  DMA_BEAT_SIZE_WORD
+};
+
+enum dma_event_output_selection { DMA_EVENT_OUTPUT_DISABLE = 0 };
+
+enum dma_block_action {
+  DMA_BLOCK_ACTION_NOACT = 0,
+  DMA_BLOCK_ACTION_INT,
+  DMA_BLOCK_ACTION_SUSPEND,
+  DMA_BLOCK_ACTION_BOTH
+};
+
+enum dma_step_selection { DMA_STEPSEL_DST = 0, DMA_STEPSEL_SRC };
+
+enum dma_address_increment_stepsize { DMA_ADDRESS_INCREMENT_STEP_SIZE_1 = 0 };
+
+enum dma_transfer_trigger_action {
+  DMA_TRIGGER_ACTON_BLOCK = 0,
+  DMA_TRIGGER_ACTON_BEAT = 2,
+  DMA_TRIGGER_ACTON_TRANSACTION = 3
+};
+
+enum dma_callback_type {
+  DMA_CALLBACK_TRANSFER_DONE = 0,
+  DMA_CALLBACK_TRANSFER_ERROR,
+  DMA_CALLBACK_N = 3
+};
+
+class Adafruit_ZeroDMA {
+public:
+  Adafruit_ZeroDMA(void);
+  ZeroDMAstatus allocate(void);
+  ZeroDMAstatus free(void);
+  ZeroDMAstatus startJob(void);
+  void abort(void);
+  void setTrigger(uint8_t trigger) { this->trigger = trigger; }
+  void setAction(dma_transfer_trigger_action action) { this->action = action; }
+  void setCallback(void (*callback)(Adafruit_ZeroDMA *) = NULL,
+                   dma_callback_type type = DMA_CALLBACK_TRANSFER_DONE);
+  DmacDescriptor *addDescriptor(void *src, void *dst, uint32_t count = 0,
+                                dma_beat_size size = DMA_BEAT_SIZE_BYTE,
+                                bool srcInc = true, bool dstInc = true);
+  uint8_t getChannel(void) const { return channel; }
+
+  // Public so the DMAC model can call back; trigger and action are only
+  // recorded (every beat is taken to be one pixel clock).
+  void (*callback[DMA_CALLBACK_N])(Adafruit_ZeroDMA *);
+  uint8_t trigger;
+  dma_transfer_trigger_action action;
+
+private:
+  uint8_t channel; // 0xFF if not allocated
+};
+
+/// @endcond
+
+#endif // _HOST_SIM_ADAFRUIT_ZERODMA_H_
@@ -0,0 +1,179 @@
+// Host stand-in for the Arduino core and the SAMD21 registers that
+// Adafruit_CompositeVideo touches, so the library can be compiled and run
+// on a desktop machine by sim.cpp. Only what the library uses is here.
+// DMA descriptors have the real SAMD21 layout, since the simulator walks
+// them exactly as the DMAC would; other peripherals are plain storage.
+
+#ifndef _HOST_SIM_ARDUINO_H_
+#define _HOST_SIM_ARDUINO_H_
+
+/// @cond HOST_SIM
+
+#include <malloc.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean;
+
+#define F_CPU 48000000L
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+#define A0 14
+
+template <class T> T min(T a, T b) { return (a < b) ? a : b; }
+template <class T> T max(T a, T b) { return (a > b) ? a : b; }
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+void analogWriteResolution(int bits);
+void analogWrite(int pin, int value);
+uint32_t micros(void); // Simulated time, from DMA beats output
+uint32_t millis(void);
+void delay(uint32_t ms); // Runs the simulated DMA for that long
+
+// There's no concurrency on the host: the simulated DMA (and its
+// interrupt) only runs when waited on, so interrupt masking is a no-op.
+// WFE runs the DMA up to and including the next interrupt. IPSR is the
+// DMAC's exception number while its callbacks run, 0 otherwise.
+#define DMAC_IPSR (16 + 6) // DMAC_IRQn on SAMD21
+extern uint32_t simIPSR;
+inline void __disable_irq(void) {}
+inline void __enable_irq(void) {}
+inline uint32_t __get_IPSR(void) { return simIPSR; }
+void __WFE(void);
+
+class Print {
+public:
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n);
+  size_t print(const char *s);
+  size_t print(long n);
+  size_t print(int n) { return print((long)n); }
+  size_t print(unsigned long n);
+  size_t print(unsigned int n) { return print((unsigned long)n); }
+  virtual ~Print() {}
+};
+
+// SAMD21 registers --------------------------------------------------------
+
+// Generic 8/16/32-bit register; 'bit' members are only those the library
+// reads back (status polls), which always read as 0 (ready) here.
+typedef union {
+  struct {
+    uint32_t ENABLE : 1, SYNCBUSY : 1, REFSEL : 2;
+  } bit;
+  volatile uint32_t reg;
+} SimReg;
+
+// DMAC_BTCTRL_Type, as in the SAMD21 CMSIS headers
+typedef union {
+  struct {
+    uint16_t VALID : 1;
+    uint16_t EVOSEL : 2;
+    uint16_t BLOCKACT : 2;
+    uint16_t : 3;
+    uint16_t BEATSIZE : 2;
+    uint16_t SRCINC : 1;
+    uint16_t DSTINC : 1;
+    uint16_t STEPSEL : 1;
+    uint16_t STEPSIZE : 3;
+  } bit;
+  uint16_t reg;
+} DMAC_BTCTRL_Type;
+
+typedef union {
+  uint16_t reg;
+} DMAC_BTCNT_Type;
+
+typedef union {
+  uint32_t reg;
+} DMAC_ADDR_Type;
+
+typedef struct {
+  volatile DMAC_BTCTRL_Type BTCTRL;
+  volatile DMAC_BTCNT_Type BTCNT;
+  volatile DMAC_ADDR_Type SRCADDR;
+  volatile DMAC_ADDR_Type DSTADDR;
+  volatile DMAC_ADDR_Type DESCADDR;
+} __attribute__((aligned(8))) DmacDescriptor;
+
+typedef struct {
+  SimReg BASEADDR, WRBADDR;
+} Dmac;
+
+typedef struct {
+  SimReg CLKCTRL, STATUS;
+} Gclk;
+
+typedef struct {
+  struct {
+    SimReg CTRLA, STATUS, CC[2];
+  } COUNT16;
+} Tc;
+
+typedef struct {
+  SimReg CTRLA, WAVE, PER, SYNCBUSY;
+} Tcc;
+
+typedef struct {
+  SimReg CTRLB, STATUS, DATA;
+} Dac;
+
+// Host pointers are 64-bit; those given to the DMA are mapped to 32-bit
+// handles and back (see sim_core.cpp), in place of the library's casts.
+uint32_t simDmaAddr(const volatile void *p);
+void *simDmaPtr(uint32_t a);
+#define COMPOSITE_DMA_ADDR(p) simDmaAddr(p)
+#define COMPOSITE_DMA_PTR(a) simDmaPtr(a)
+
+extern Dmac simDMAC;
+extern Gclk simGCLK;
+extern Tc simTC3, simTC4, simTC5;
+extern Tcc simTCC0, simTCC1, simTCC2;
+extern Dac simDAC;
+
+#define DMAC (&simDMAC)
+#define GCLK (&simGCLK)
+#define TC3 (&simTC3)
+#define TC4 (&simTC4)
+#define TC5 (&simTC5)
+#define TCC0 (&simTCC0)
+#define TCC1 (&simTCC1)
+#define TCC2 (&simTCC2)
+#define DAC (&simDAC)
+
+#define GCLK_CLKCTRL_CLKEN (1 << 14)
+#define GCLK_CLKCTRL_GEN(n) ((n) << 8)
+#define GCLK_CLKCTRL_GEN_GCLK0 GCLK_CLKCTRL_GEN(0)
+#define GCLK_CLKCTRL_ID(n) (n)
+#define GCLK_GEN_NUM 9
+#define GCM_TCC0_TCC1 0x1A
+#define GCM_TCC2_TC3 0x1B
+#define GCM_TC4_TC5 0x1C
+
+#define TC_CTRLA_ENABLE (1 << 1)
+#define TC_CTRLA_MODE_COUNT16 (0 << 2)
+#define TC_CTRLA_WAVEGEN_MFRQ (1 << 5)
+#define TC_CTRLA_PRESCALER_DIV1 (0 << 8)
+#define TCC_CTRLA_ENABLE (1 << 1)
+#define TCC_CTRLA_PRESCALER_DIV1 (0 << 8)
+#define TCC_WAVE_WAVEGEN_NFRQ 0
+
+#define TCC0_DMAC_ID_OVF 0x0D
+#define TCC1_DMAC_ID_OVF 0x11
+#define TCC2_DMAC_ID_OVF 0x14
+#define TC3_DMAC_ID_OVF 0x18
+#define TC4_DMAC_ID_OVF 0x1B
+#define TC5_DMAC_ID_OVF 0x1E
+
+/// @endcond
+
+#endif // _HOST_SIM_ARDUINO_H_
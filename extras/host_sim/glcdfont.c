@@ -0,0 +1,10 @@
+// Host stand-in for Adafruit_GFX's classic 5x7 font. The real glyph data
+// isn't needed to time or check drawing, so sim_core.cpp fills this with
+// a made-up pattern (different for each character) at startup.
+
+#ifndef FONT5X7_H
+#define FONT5X7_H
+
+extern unsigned char font[256 * 5];
+
+#endif // FONT5X7_H
@@ -0,0 +1,1068 @@
+// Host-side simulator for Adafruit_CompositeVideo. The library itself is
+// compiled in (this file includes the .cpp, for access to the mode tables)
+// against stand-in Arduino, Adafruit_GFX and Adafruit_ZeroDMA headers, and
+// the DMA descriptor list it builds is walked by a model of the DMAC (see
+// sim_core.cpp), producing the DAC sample stream the board would output.
+//
+//   sim check            Run every display class and begin() option,
+//                        checking the DMA list and output (exit status 1
+//                        on any failure).
+//   sim bench            Time drawing calls, begin() and the per-field
+//                        interrupt work, in host nanoseconds. Only useful
+//                        relative to other runs on the same machine.
+//   sim dump CLASS FLAGS NAME
+//                        Draw a test image and save one output frame as
+//                        NAME.pgm (one row per scanline, one pixel per
+//                        pixel clock) and NAME.csv (sample index, DAC
+//                        value). CLASS is e.g. NTSC80x24, FLAGS e.g. 0 or
+//                        PACKED8+DOUBLEBUFFER.
+//
+// Build with the Makefile here; 'make check' builds with and without
+// COMPOSITE_VSYNC_RAM and runs both.
+
+#include "../../Adafruit_CompositeVideo.cpp"
+#include "sim_core.h"
+#include <algorithm>
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+// DISPLAY CLASSES & FLAGS -------------------------------------------------
+
+template <class T> static Adafruit_CompositeVideo *make(void) {
+  return new T;
+}
+
+static const struct {
+  const char *name;
+  uint8_t mode;
+  uint16_t frameLines; // Scanlines per interlaced frame
+  Adafruit_CompositeVideo *(*make)(void);
+} displays[] = {
+    {"NTSC40x24", MODE_NTSC40x24, 525, make<Adafruit_NTSC40x24>},
+    {"NTSC40x48", MODE_NTSC40x48, 525, make<Adafruit_NTSC40x48>},
+    {"NTSC80x24", MODE_NTSC80x24, 525, make<Adafruit_NTSC80x24>},
+    {"NTSC80x48", MODE_NTSC80x48, 525, make<Adafruit_NTSC80x48>},
+    {"PAL40x25", MODE_PAL40x25, 625, make<Adafruit_PAL40x25>},
+};
+#define NUM_DISPLAYS (sizeof displays / sizeof displays[0])
+
+static const struct {
+  const char *name;
+  uint8_t flag;
+} flagNames[] = {
+    {"DOUBLEBUFFER", COMPOSITE_DOUBLEBUFFER},
+    {"COMPACT", COMPOSITE_COMPACT},
+    {"PACKED4", COMPOSITE_PACKED4},
+    {"PACKED8", COMPOSITE_PACKED8},
+    {"TEXT", COMPOSITE_TEXT},
+    {"INTERLACE", COMPOSITE_INTERLACE},
+};
+
+static const char *flagString(uint8_t flags) {
+  static char buf[96];
+  buf[0] = 0;
+  for (size_t i = 0; i < sizeof flagNames / sizeof flagNames[0]; i++) {
+    if (flags & flagNames[i].flag) {
+      if (buf[0])
+        strcat(buf, "+");
+      strcat(buf, flagNames[i].name);
+    }
+  }
+  return buf[0] ? buf : "0";
+}
+
+static int parseFlags(const char *s) {
+  int flags = 0;
+  while (*s) {
+    size_t n = strcspn(s, "+|");
+    size_t i = 0;
+    for (; i < sizeof flagNames / sizeof flagNames[0]; i++) {
+      if ((strlen(flagNames[i].name) == n) &&
+          !strncmp(flagNames[i].name, s, n))
+        break;
+    }
+    if (i < sizeof flagNames / sizeof flagNames[0])
+      flags |= flagNames[i].flag;
+    else if ((n != 1) || (*s != '0'))
+      return -1;
+    s += n;
+    if (*s)
+      s++;
+  }
+  return flags;
+}
+
+// OUTPUT CAPTURE ----------------------------------------------------------
+
+// Field ends seen by the onVBlank() callback, as sample counts at the time
+static std::vector<uint16_t> samples;
+static std::vector<size_t> fieldEnds;
+static std::vector<uint8_t> fieldParity;
+
+static void onField(uint8_t field) {
+  fieldEnds.push_back(samples.size());
+  fieldParity.push_back(field);
+}
+
+static uint32_t videoErrors = 0;
+
+static void fail(const char *what, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  printf("FAIL %s: ", what);
+  vprintf(fmt, args);
+  printf("\n");
+  va_end(args);
+  videoErrors++;
+}
+
+// Capture one whole frame, odd field then even, starting just after an
+// even field ends (i.e. with the odd field's vertical sync). Returns
+// false if the fields don't arrive.
+static bool captureFrame(Adafruit_CompositeVideo *display,
+                         std::vector<uint16_t> &frame) {
+  samples.clear();
+  fieldEnds.clear();
+  fieldParity.clear();
+  simCapture = &samples;
+  display->onVBlank(onField);
+  size_t start = 0, end = 0;
+  // A frame at a time (at most 650 lines of 204), up to four frames
+  for (int n = 0; (n < 4) && (end <= start) && simRunning(); n++) {
+    simRun(650 * 204);
+    for (size_t i = 0; i + 2 < fieldParity.size(); i++) {
+      if ((fieldParity[i] == 2) && (fieldParity[i + 1] == 1) &&
+          (fieldParity[i + 2] == 2)) {
+        start = fieldEnds[i];
+        end = fieldEnds[i + 2];
+        break;
+      }
+    }
+  }
+  display->onVBlank(NULL);
+  simCapture = NULL;
+  if (end <= start)
+    return false;
+  frame.assign(samples.begin() + start, samples.begin() + end);
+  return true;
+}
+
+// CHECKS ------------------------------------------------------------------
+
+// The same test image on any display (and any FLAGS, within PACKED4's 16
+// levels, so packed and 16-bit output can be compared exactly): a
+// gradient, a box, a diagonal and some text. Drawn on a canvas, it gives
+// the gray values to compare other ways of getting it on screen with.
+static void drawTestImage(Adafruit_GFX *display) {
+  int16_t w = display->width(), h = display->height();
+  display->fillScreen(0);
+  for (int16_t y = 0; y < h; y++)
+    display->drawLine(0, y, w - 1, y, (y * 15 / (h - 1)) * 17);
+  display->fillRect(w / 4, h / 4, w / 2, h / 2, 255);
+  display->drawLine(0, 0, w - 1, h - 1, 0);
+  display->setTextColor(136);
+  display->setCursor(1, 1);
+  display->print("Hi!");
+}
+
+// Structure of one captured frame: whole lines, each starting with sync,
+// and the same number of sync-level samples as the tables hold (pixel
+// rows are copies of a blank line, so sync only ever comes from there).
+static void checkFrame(const char *what, uint8_t mode, uint16_t frameLines,
+                       const std::vector<uint16_t> &frame) {
+  uint8_t rpc = videoSpec[mode].rowPixelClocks;
+  if (frame.size() != (size_t)frameLines * rpc) {
+    fail(what, "frame is %u samples, expected %u lines of %u",
+         (unsigned)frame.size(), frameLines, rpc);
+    return;
+  }
+  for (uint16_t l = 0; l < frameLines; l++) {
+    if (frame[l * rpc] != NS) {
+      fail(what, "line %u of frame doesn't start with sync", l);
+      return;
+    }
+  }
+  size_t expect = 0, got = 0;
+  for (uint8_t f = 0; f < 2; f++) {
+    for (uint16_t i = 0; i < videoSpec[mode].vsyncLen[f]; i++)
+      expect += videoSpec[mode].vsync[f][i] == NS;
+  }
+  uint16_t blank = 0; // In a blank line (the first of the odd vsync table)
+  for (uint8_t i = 0; i < rpc; i++)
+    blank += videoSpec[mode].vsync[0][i] == NS;
+  expect += 2 * videoSpec[mode].scanlines * blank;
+  for (size_t i = 0; i < frame.size(); i++)
+    got += frame[i] == NS;
+  if (got != expect)
+    fail(what, "%u sync-level samples, expected %u", (unsigned)got,
+         (unsigned)expect);
+}
+
+// 16-bit framebuffers, which the DMA reads and fillLevel() fills a word at
+// a time, must be word-aligned (packed ones are only ever read as bytes)
+static void checkBuffers(const char *what, Adafruit_CompositeVideo *display,
+                         uint8_t flags) {
+  uint32_t bytes;
+  uint8_t *p = display->getFrameData(&bytes);
+  if (!p || !bytes)
+    fail(what, "getFrameData() returned nothing while running");
+  if (!(flags & LINEBUFFER_FLAGS) && ((uintptr_t)p & 3))
+    fail(what, "frame data at %p not word-aligned", p);
+}
+
+static void checkSimErrors(const char *what) {
+  if (simErrors)
+    fail(what, "%u DMA error(s), first: %s", simErrors, simFirstError);
+  simErrors = 0;
+}
+
+// Run one display class with one set of flags, returning its frame
+static bool runOne(size_t d, uint8_t flags, std::vector<uint16_t> &frame) {
+  char what[64];
+  snprintf(what, sizeof what, "%s %s", displays[d].name, flagString(flags));
+  Adafruit_CompositeVideo *display = displays[d].make();
+  bool ok = false;
+  if (display->getFrameData())
+    fail(what, "getFrameData() not NULL before begin()");
+  if (!display->begin(flags)) {
+    fail(what, "begin() failed");
+  } else {
+    checkBuffers(what, display, flags);
+    drawTestImage(display);
+    if (flags & COMPOSITE_DOUBLEBUFFER)
+      display->swapBuffers(true);
+    if (!captureFrame(display, frame)) {
+      fail(what, "no complete frame output");
+    } else {
+      checkFrame(what, displays[d].mode, displays[d].frameLines, frame);
+      ok = true;
+    }
+    display->end();
+    if (simRunning())
+      fail(what, "DMA still running after end()");
+  }
+  checkSimErrors(what);
+  delete display;
+  return ok;
+}
+
+// Pre-emphasis and other per-line processing mustn't depend on the order
+// things were drawn in: a bitmap drawn in two pieces, right half first,
+// must come out the same as drawn in one go.
+static void checkDrawOrder(size_t d, uint8_t flags) {
+  char what[80];
+  snprintf(what, sizeof what, "%s %s draw order", displays[d].name,
+           flagString(flags));
+  Adafruit_CompositeVideo *display = displays[d].make();
+  if (!display->begin(flags)) {
+    fail(what, "begin() failed");
+    delete display;
+    return;
+  }
+  int16_t w = display->width(), h = display->height(), half = w / 2;
+  uint8_t *bitmap = (uint8_t *)malloc(w * h);
+  uint8_t *piece = (uint8_t *)malloc(w * h);
+  for (int i = 0; i < w * h; i++)
+    bitmap[i] = (i * 73 + (i / w) * 29) & 0xF0; // Big steps
+  display->setPreEmphasis(4);
+  std::vector<uint16_t> whole, pieces;
+  display->fillScreen(0);
+  display->drawGrayscaleBitmap(0, 0, bitmap, w, h);
+  captureFrame(display, whole);
+  display->fillScreen(0);
+  for (int16_t y = 0; y < h; y++)
+    memcpy(&piece[y * (w - half)], &bitmap[y * w + half], w - half);
+  display->drawGrayscaleBitmap(half, 0, piece, w - half, h);
+  for (int16_t y = 0; y < h; y++)
+    memcpy(&piece[y * half], &bitmap[y * w], half);
+  display->drawGrayscaleBitmap(0, 0, piece, half, h);
+  captureFrame(display, pieces);
+  if (whole.empty() || (whole != pieces))
+    fail(what, "output depends on drawing order");
+  display->end();
+  checkSimErrors(what);
+  free(piece);
+  free(bitmap);
+  delete display;
+}
+
+// Pre-emphasis, packed modes only, changes output just where brightness
+// changes (overshooting in the same direction), leaving flat runs alone;
+// 16-bit modes refuse it, and end() turns it off again
+static void checkPreEmphasis(size_t d) {
+  char what[64];
+  snprintf(what, sizeof what, "%s pre-emphasis", displays[d].name);
+  std::vector<uint16_t> ref, frame;
+  if (!runOne(d, COMPOSITE_PACKED8, ref))
+    return;
+  Adafruit_CompositeVideo *display = displays[d].make();
+  if (display->begin()) {
+    if (display->setPreEmphasis(4))
+      fail(what, "accepted in a 16-bit mode");
+    display->end();
+  }
+  if (display->begin(COMPOSITE_PACKED8)) {
+    drawTestImage(display);
+    if (!display->setPreEmphasis(4))
+      fail(what, "refused in PACKED8");
+    captureFrame(display, frame);
+    size_t edges = 0, wrong = 0;
+    for (size_t i = 1; (i < ref.size()) && (frame.size() == ref.size());
+         i++) {
+      int32_t step = (int32_t)ref[i] - ref[i - 1];
+      int32_t boost = (int32_t)frame[i] - ref[i];
+      if (!step)
+        wrong += boost != 0;
+      else if (boost)
+        edges++, wrong += (boost > 0) != (step > 0);
+    }
+    if (frame.size() != ref.size())
+      fail(what, "no complete frame output");
+    else if (wrong || !edges)
+      fail(what, "%u edges boosted, %u samples wrong", (unsigned)edges,
+           (unsigned)wrong);
+    display->end();
+  }
+  if (display->begin(COMPOSITE_PACKED8)) {
+    drawTestImage(display);
+    captureFrame(display, frame);
+    if (frame != ref)
+      fail(what, "still on after end() and begin()");
+    display->end();
+  }
+  checkSimErrors(what);
+  delete display;
+}
+
+// waitForVBlank() and swapBuffers() from an onVBlank() function mustn't
+// wait for the interrupt they're called from, and the swap (and copy)
+// must still happen: swapping again from the main loop shows the same.
+static Adafruit_CompositeVideo *vBlankDisplay;
+
+static void swapInVBlank(uint8_t field) {
+  (void)field;
+  vBlankDisplay->waitForVBlank();
+  vBlankDisplay->swapBuffers(true);
+  vBlankDisplay->onVBlank(NULL);
+}
+
+static void checkInterruptSwap(size_t d, uint8_t flags) {
+  char what[80];
+  flags |= COMPOSITE_DOUBLEBUFFER;
+  snprintf(what, sizeof what, "%s %s swap in onVBlank()", displays[d].name,
+           flagString(flags));
+  std::vector<uint16_t> ref, frame;
+  if (!runOne(d, flags, ref))
+    return;
+  Adafruit_CompositeVideo *display = displays[d].make();
+  if (!display->begin(flags)) {
+    fail(what, "begin() failed");
+    delete display;
+    return;
+  }
+  drawTestImage(display);
+  vBlankDisplay = display;
+  display->onVBlank(swapInVBlank);
+  for (int n = 0; (n < 4) && display->getFieldCount() < 4; n++)
+    simRun(650 * 204);
+  display->swapBuffers(); // Copy of the test image, if copied
+  if (!captureFrame(display, frame) || (frame != ref))
+    fail(what, "test image not shown");
+  display->end();
+  checkSimErrors(what);
+  delete display;
+}
+
+// A 16-bit swapBuffers() that wakes up late, well into the next field
+// (other interrupts, or a slow wakeup), mustn't show part of a field from
+// each buffer: every field captured is all black or all white.
+static void checkLateSwap(size_t d, uint8_t flags) {
+  char what[80];
+  flags |= COMPOSITE_DOUBLEBUFFER;
+  snprintf(what, sizeof what, "%s %s late swap", displays[d].name,
+           flagString(flags));
+  Adafruit_CompositeVideo *display = displays[d].make();
+  if (!display->begin(flags)) {
+    fail(what, "begin() failed");
+    delete display;
+    return;
+  }
+  display->fillScreen(0);
+  display->swapBuffers();
+  display->fillScreen(255);
+  samples.clear();
+  fieldEnds.clear();
+  fieldParity.clear();
+  simCapture = &samples;
+  display->onVBlank(onField);
+  simWakeLate = videoSpec[displays[d].mode].rowPixelClocks *
+                display->getScanlines() / 2;
+  display->swapBuffers();
+  simWakeLate = 0;
+  simRun(650 * 204);
+  display->onVBlank(NULL);
+  simCapture = NULL;
+  bool white = false;
+  for (size_t f = 0; f + 1 < fieldEnds.size(); f++) {
+    std::vector<uint16_t>::iterator a = samples.begin() + fieldEnds[f],
+                                    b = samples.begin() + fieldEnds[f + 1];
+    bool hasBlack = std::count(a, b, NK), hasWhite = std::count(a, b, NW);
+    if (hasBlack && hasWhite)
+      fail(what, "field %u is part old buffer, part new", (unsigned)f);
+    white |= hasWhite;
+  }
+  if (!white)
+    fail(what, "new buffer not shown");
+  display->end();
+  checkSimErrors(what);
+  delete display;
+}
+
+// end() must leave nothing behind for the next begin() on the object
+static void checkRestart(size_t d) {
+  char what[64];
+  snprintf(what, sizeof what, "%s restart", displays[d].name);
+  Adafruit_CompositeVideo *display = displays[d].make();
+  std::vector<uint16_t> before, after;
+  if (display->begin()) {
+    drawTestImage(display);
+    captureFrame(display, before);
+    CompositeRasterLine *program = (CompositeRasterLine *)calloc(
+        display->getScanlines(), sizeof(CompositeRasterLine));
+    display->setRasterProgram(program);
+    display->setScrollY(3);
+    display->end();
+    memset(program, 0x55, display->getScanlines() * sizeof *program);
+    free(program); // Sketch is done with it
+    if (display->getFrameData())
+      fail(what, "getFrameData() not NULL after end()");
+  }
+  if (!display->begin()) {
+    fail(what, "begin() failed");
+  } else {
+    drawTestImage(display);
+    captureFrame(display, after);
+    if (before.empty() || (before != after))
+      fail(what, "output differs after end() and begin()");
+    display->end();
+  }
+  checkSimErrors(what);
+  delete display;
+}
+
+// Flags whose output should match flags 0, sample for sample
+static const uint8_t same[] = {
+    0,
+    COMPOSITE_DOUBLEBUFFER,
+    COMPOSITE_COMPACT,
+    COMPOSITE_COMPACT | COMPOSITE_DOUBLEBUFFER,
+    COMPOSITE_PACKED8,
+    COMPOSITE_PACKED4,
+    COMPOSITE_PACKED8 | COMPOSITE_DOUBLEBUFFER,
+    COMPOSITE_PACKED4 | COMPOSITE_DOUBLEBUFFER,
+};
+
+// Draw the test image and call setup() in each of those modes, and check
+// that the output still matches. Returns the number of runs.
+static unsigned checkAcrossModes(size_t d, const char *label,
+                                 void (*setup)(Adafruit_CompositeVideo *)) {
+  std::vector<uint16_t> ref, frame;
+  for (size_t i = 0; i < sizeof same; i++) {
+    char what[96];
+    snprintf(what, sizeof what, "%s %s %s", displays[d].name,
+             flagString(same[i]), label);
+    Adafruit_CompositeVideo *display = displays[d].make();
+    if (!display->begin(same[i])) {
+      fail(what, "begin() failed");
+    } else {
+      drawTestImage(display);
+      if (same[i] & COMPOSITE_DOUBLEBUFFER)
+        display->swapBuffers(true);
+      setup(display);
+      if (!captureFrame(display, i ? frame : ref))
+        fail(what, "no complete frame output");
+      else if (i && (frame != ref))
+        fail(what, "output differs from flags 0");
+      display->end();
+    }
+    checkSimErrors(what);
+    delete display;
+  }
+  return sizeof same;
+}
+
+// Raster program showing every row in order, but with every fourth line
+// blank (row -1) and one past the framebuffer, which is blank too
+static std::vector<CompositeRasterLine> program;
+
+static void setBlankRaster(Adafruit_CompositeVideo *display) {
+  uint16_t lines = display->getScanlines();
+  program.assign(lines, CompositeRasterLine());
+  for (uint16_t i = 0; i < lines; i++) {
+    program[i].row = (i % 4 == 1) ? -1 : i * display->height() / lines;
+    program[i].brightness = 255;
+  }
+  program[lines / 2].row = display->height();
+  display->setRasterProgram(program.data());
+}
+
+// Rows a fixed height, not filling the screen, with blank lines around
+static void setShortRows(Adafruit_CompositeVideo *display) {
+  int16_t lines = display->getScanlines() / display->height() - 2;
+  if (!display->setRowHeight((lines < 1) ? 1 : lines, 7))
+    fail("setRowHeight()", "rejected %d lines per row", lines);
+}
+
+// Levels and gamma (shared by all objects), set after drawing: 16-bit
+// framebuffers are converted, packed ones just use the new table
+static void setWideLevels(Adafruit_CompositeVideo *display) {
+  display->setLevels(50, 600);
+  display->setGamma(1.5);
+}
+
+static void resetLevels(void) {
+  Adafruit_NTSC40x24 any; // Whichever object; the table is global
+  any.setLevels(NK, NW);
+  any.setGamma(1.0);
+  if (grayLUT != defaultGrayLUT)
+    fail("setLevels()", "not back to the flash table at the defaults");
+}
+
+// setLevels() gives exactly the levels asked for; asking for the defaults
+// (from another object, or via setGamma(1.0)) gives the same frame as
+// never having changed them, in 16-bit and packed modes (packed ones by
+// way of a gamma that merges dark grays).
+static void checkLevels(size_t d, uint8_t flags) {
+  char what[80];
+  snprintf(what, sizeof what, "%s %s levels", displays[d].name,
+           flagString(flags));
+  std::vector<uint16_t> ref, frame;
+  if (!runOne(d, flags, ref))
+    return;
+  Adafruit_CompositeVideo *display = displays[d].make();
+  if (!display->begin(flags)) {
+    fail(what, "begin() failed");
+    delete display;
+    return;
+  }
+  drawTestImage(display);
+  Adafruit_NTSC40x24 other;
+  other.setLevels(50, 600); // Not display's object, but converts it
+  captureFrame(display, frame);
+  if (!std::count(frame.begin(), frame.end(), 50) ||
+      !std::count(frame.begin(), frame.end(), 600))
+    fail(what, "setLevels(50, 600) output doesn't reach 50 and 600");
+  if (flags & LINEBUFFER_FLAGS)
+    display->setGamma(2.2); // Only exact in packed modes (see setLevels())
+  display->setLevels(NK, NW);
+  display->setGamma(1.0);
+  captureFrame(display, frame);
+  if (frame != ref)
+    fail(what, "output differs after setting levels back to defaults");
+  display->end();
+  resetLevels();
+  checkSimErrors(what);
+  delete display;
+}
+
+// SCROLL, SPRITE, RLE & CANVAS CHECKS -------------------------------------
+// Each way of getting pixels on screen, in each of the same[] modes, must
+// give the same frame as drawing them directly in a 16-bit framebuffer.
+
+// Capture a frame after draw() (and swapBuffers(true), if double-buffered)
+static bool captureWith(size_t d, uint8_t flags, const char *what,
+                        void (*draw)(Adafruit_CompositeVideo *),
+                        std::vector<uint16_t> &frame) {
+  Adafruit_CompositeVideo *display = displays[d].make();
+  bool ok = display->begin(flags);
+  if (!ok) {
+    fail(what, "begin() failed");
+  } else {
+    draw(display);
+    if (flags & COMPOSITE_DOUBLEBUFFER)
+      display->swapBuffers(true);
+    if (!(ok = captureFrame(display, frame)))
+      fail(what, "no complete frame output");
+    display->end();
+  }
+  checkSimErrors(what);
+  delete display;
+  return ok;
+}
+
+// Check that draw() in each of the same[] modes (only packed ones if
+// packedOnly) gives the frame that ref() does in 16-bit mode. Returns
+// the number of runs.
+static unsigned compareModes(size_t d, const char *label,
+                             void (*draw)(Adafruit_CompositeVideo *),
+                             void (*ref)(Adafruit_CompositeVideo *),
+                             bool packedOnly = false) {
+  char what[96];
+  snprintf(what, sizeof what, "%s %s reference", displays[d].name, label);
+  std::vector<uint16_t> expect, frame;
+  if (!captureWith(d, 0, what, ref, expect))
+    return 1;
+  unsigned runs = 1;
+  for (size_t i = 0; i < sizeof same; i++) {
+    if (packedOnly && !(same[i] & LINEBUFFER_FLAGS))
+      continue;
+    snprintf(what, sizeof what, "%s %s %s", displays[d].name,
+             flagString(same[i]), label);
+    if (captureWith(d, same[i], what, draw, frame) && (frame != expect))
+      fail(what, "output differs from drawing directly");
+    runs++;
+  }
+  return runs;
+}
+
+// Test image as gray values, optionally changed by changeTestImage()
+static void changeTestImage(Adafruit_GFX *display);
+
+static void testImageGrays(Adafruit_CompositeVideo *display,
+                           std::vector<uint8_t> &gray, bool changed) {
+  int16_t w = display->width(), h = display->height();
+  GFXcanvas8 canvas(w, h);
+  drawTestImage(&canvas);
+  if (changed)
+    changeTestImage(&canvas);
+  gray.assign(canvas.getBuffer(), canvas.getBuffer() + w * h);
+}
+
+// Scrolling wraps around: scrolled by (x, y), the test image looks the same
+// as drawn shifted that much (x only in packed modes, the others ignore
+// it). Whole turns are no scroll at all.
+static int16_t shiftX, shiftY;
+
+static void drawShifted(Adafruit_CompositeVideo *display) {
+  int16_t w = display->width(), h = display->height();
+  std::vector<uint8_t> gray, shifted(w * h);
+  testImageGrays(display, gray, false);
+  for (int16_t y = 0; y < h; y++) {
+    for (int16_t x = 0; x < w; x++)
+      shifted[y * w + x] = gray[((y + shiftY) % h + h) % h * w +
+                                ((x + shiftX) % w + w) % w];
+  }
+  display->drawGrayscaleBitmap(0, 0, shifted.data(), w, h);
+}
+
+static void drawScrolled(Adafruit_CompositeVideo *display) {
+  drawTestImage(display);
+  display->setScrollX(shiftX);
+  display->setScrollY(shiftY);
+}
+
+static unsigned checkScroll(size_t d) {
+  Adafruit_CompositeVideo *display = displays[d].make();
+  int16_t w = display->width(), h = display->height();
+  delete display;
+  const struct {
+    int16_t x, y;
+  } scrollBy[] = {{0, 3}, {5, -1}, {w, h}, {-1, (int16_t)(2 * h + 2)}};
+  unsigned runs = 0;
+  for (size_t n = 0; n < sizeof scrollBy / sizeof scrollBy[0]; n++) {
+    char label[48];
+    snprintf(label, sizeof label, "scroll %d,%d", scrollBy[n].x,
+             scrollBy[n].y);
+    shiftX = scrollBy[n].x;
+    shiftY = scrollBy[n].y;
+    runs += compareModes(d, label, drawScrolled, drawShifted, true);
+    for (size_t i = 0; i < sizeof same; i++) {
+      if (same[i] & LINEBUFFER_FLAGS)
+        continue;
+      char what[96];
+      snprintf(what, sizeof what, "%s %s %s", displays[d].name,
+               flagString(same[i]), label);
+      std::vector<uint16_t> expect, frame;
+      shiftX = 0; // 16-bit modes scroll vertically only
+      captureWith(d, 0, what, drawShifted, expect);
+      shiftX = scrollBy[n].x;
+      if (captureWith(d, same[i], what, drawScrolled, frame) &&
+          (frame != expect))
+        fail(what, "output differs from drawing shifted");
+      runs += 2;
+    }
+  }
+  return runs;
+}
+
+// Sprites, clipped at every edge and overlapping (higher numbers on top),
+// positioned on screen regardless of scrolling; then moved and hidden
+static const uint8_t spriteMask[8] = {0x81, 0x42, 0x24, 0x18,
+                                      0x18, 0x24, 0x42, 0x81};
+static uint8_t spriteBitmap[3][64];
+static bool spritesMoved;
+
+#define FROM_RIGHT 1  // x is from the right edge
+#define FROM_BOTTOM 2 // y is from the bottom edge
+
+static const struct SpriteSpot {
+  uint8_t n;
+  int16_t x, y;
+  uint8_t edge, bitmap;
+  bool masked;
+} spriteSpots[2][4] = {
+    {{0, -3, 2, 0, 0, false}, // Over the left edge, under sprite 2
+     {1, -5, -4, FROM_RIGHT | FROM_BOTTOM, 1, true},
+     {2, 1, 1, 0, 2, true},
+     {7, 10, -6, 0, 0, false}}, // Over the top
+    {{0, 2, 3, 0, 0, false},    // Moved, now under sprite 1
+     {1, 4, 4, 0, 1, true},
+     {2, 1, 1, 0, 2, true}, // Hidden
+     {7, 10, -6, 0, 0, false}},
+};
+#define SPRITE_SCROLL 5
+
+static void spriteXY(Adafruit_CompositeVideo *display, const SpriteSpot *s,
+                     int16_t *x, int16_t *y) {
+  *x = s->x + ((s->edge & FROM_RIGHT) ? display->width() : 0);
+  *y = s->y + ((s->edge & FROM_BOTTOM) ? display->height() : 0);
+}
+
+static void drawSprites(Adafruit_CompositeVideo *display) {
+  int16_t w = display->width(), h = display->height();
+  drawTestImage(display);
+  display->setScrollY(SPRITE_SCROLL);
+  for (uint8_t k = 0; k < 4; k++) {
+    const SpriteSpot *s = &spriteSpots[spritesMoved][k];
+    if (spritesMoved && (s->n == 2))
+      continue; // Hidden
+    int16_t sx, sy;
+    spriteXY(display, s, &sx, &sy);
+    for (int16_t r = 0; r < 8; r++) {
+      for (int16_t c = 0; c < 8; c++) {
+        int16_t x = sx + c, y = sy + r;
+        if ((s->masked && !(spriteMask[r] & (0x80 >> c))) || (x < 0) ||
+            (x >= w) || (y < 0) || (y >= h))
+          continue;
+        display->drawPixel(x, (y + SPRITE_SCROLL) % h,
+                           spriteBitmap[s->bitmap][r * 8 + c]);
+      }
+    }
+  }
+}
+
+static void setSprites(Adafruit_CompositeVideo *display) {
+  drawTestImage(display);
+  display->setScrollY(SPRITE_SCROLL);
+  for (uint8_t k = 0; k < 4; k++) {
+    const SpriteSpot *s = &spriteSpots[0][k];
+    int16_t x, y;
+    spriteXY(display, s, &x, &y);
+    if (!display->setSprite(s->n, x, y, spriteBitmap[s->bitmap],
+                            s->masked ? spriteMask : NULL))
+      fail("setSprite()", "refused in a packed mode");
+  }
+  if (!spritesMoved)
+    return;
+  display->waitForVBlank(); // Shown for a field, then...
+  for (uint8_t k = 0; k < 2; k++) {
+    const SpriteSpot *s = &spriteSpots[1][k];
+    int16_t x, y;
+    spriteXY(display, s, &x, &y);
+    display->moveSprite(s->n, x, y);
+  }
+  display->setSprite(2, 0, 0, NULL);
+}
+
+static unsigned checkSprites(size_t d) {
+  for (int i = 0; i < 64; i++) {
+    spriteBitmap[0][i] = i * 4;
+    spriteBitmap[1][i] = 255 - i * 3;
+    spriteBitmap[2][i] = (i & 1) ? 255 : 17;
+  }
+  unsigned runs = 0;
+  for (int moved = 0; moved < 2; moved++) {
+    spritesMoved = moved;
+    runs += compareModes(d, moved ? "sprites moved" : "sprites", setSprites,
+                         drawSprites, true);
+  }
+  return runs;
+}
+
+// RLE frames: the test image from black, then a change to it, decode to
+// the same as drawing both directly. Encoded here rather than with
+// extras/rle_encode.py, to need nothing but a C++ compiler.
+static void changeTestImage(Adafruit_GFX *display) {
+  int16_t w = display->width(), h = display->height();
+  display->fillRect(w / 8, h / 2, w / 3, h / 3, 51);
+  display->drawLine(0, h - 1, w - 1, 0, 204);
+  display->drawLine(w / 2, h / 8, w - 2, h / 8, 119);
+}
+
+// Encode cur as drawRLEFrame() reads it (the format is described there),
+// skipping pixels unchanged from prev: runs of 3 or more, literals
+// otherwise. codes[] counts skips, runs and literals.
+static void encodeRLE(const std::vector<uint8_t> &prev,
+                      const std::vector<uint8_t> &cur,
+                      std::vector<uint8_t> &out, unsigned codes[3]) {
+  size_t n = cur.size();
+  for (size_t i = 0, k; i < n; i += k) {
+    k = 1;
+    if (cur[i] == prev[i]) {
+      while ((i + k < n) && (k < 128) && (cur[i + k] == prev[i + k]))
+        k++;
+      out.push_back(k - 1);
+      codes[0]++;
+      continue;
+    }
+    while ((i + k < n) && (k < 64) && (cur[i + k] == cur[i]))
+      k++;
+    if (k >= 3) {
+      out.push_back(0x80 + k - 1);
+      out.push_back(cur[i]);
+      codes[1]++;
+      continue;
+    }
+    for (k = 1; (i + k < n) && (k < 64) && (cur[i + k] != prev[i + k]) &&
+                !((i + k + 2 < n) && (cur[i + k + 1] == cur[i + k]) &&
+                  (cur[i + k + 2] == cur[i + k]));
+         k++)
+      ;
+    out.push_back(0xC0 + k - 1);
+    out.insert(out.end(), cur.begin() + i, cur.begin() + i + k);
+    codes[2]++;
+  }
+}
+
+static void drawBothDirectly(Adafruit_CompositeVideo *display) {
+  drawTestImage(display);
+  changeTestImage(display);
+}
+
+static void drawBothRLE(Adafruit_CompositeVideo *display) {
+  std::vector<uint8_t> black(display->width() * display->height(), 0);
+  std::vector<uint8_t> first, second, stream;
+  unsigned codes[3] = {0, 0, 0};
+  testImageGrays(display, first, false);
+  testImageGrays(display, second, true);
+  encodeRLE(black, first, stream, codes);
+  encodeRLE(first, second, stream, codes);
+  if (!codes[0] || !codes[1] || !codes[2])
+    fail("RLE", "test frames don't use every code");
+  display->fillScreen(0);
+  const uint8_t *p = display->drawRLEFrame(stream.data());
+  if (p)
+    p = display->drawRLEFrame(p);
+  if (p != stream.data() + stream.size())
+    fail("drawRLEFrame()", "didn't end where the frames do");
+}
+
+// Canvas: flush() copies what's drawn, then only the dirty area (leaving
+// pixels drawn on the display directly alone), and clips at the edges
+static void drawCanvasDirectly(Adafruit_CompositeVideo *display) {
+  int16_t w = display->width(), h = display->height();
+  drawTestImage(display);
+  display->fillRect(0, h - 2, 4, 2, 255);
+  display->fillRect(3, 2, 5, 4, 68);
+  display->fillRect(w - 4, h / 2, 10, 6, 119);
+}
+
+static void drawCanvas(Adafruit_CompositeVideo *display) {
+  int16_t w = display->width(), h = display->height();
+  Adafruit_CompositeCanvas canvas(w, h), small(10, 6);
+  drawTestImage(&canvas);
+  canvas.flush(*display);
+  display->fillRect(0, h - 2, 4, 2, 255);
+  canvas.fillRect(3, 2, 5, 4, 68);
+  canvas.flush(*display);
+  small.fillScreen(119);
+  small.flush(*display, w - 4, h / 2);
+  if (canvas.isDirty() || small.isDirty())
+    fail("flush()", "canvas still dirty");
+}
+
+static int check(void) {
+  // ...and that match COMPOSITE_INTERLACE
+  static const uint8_t sameInterlaced[] = {
+      COMPOSITE_INTERLACE,
+      COMPOSITE_INTERLACE | COMPOSITE_DOUBLEBUFFER,
+      COMPOSITE_INTERLACE | COMPOSITE_PACKED8,
+      COMPOSITE_INTERLACE | COMPOSITE_PACKED4 | COMPOSITE_COMPACT,
+  };
+  // ...and text modes, only checked for structure
+  static const uint8_t text[] = {
+      COMPOSITE_TEXT,
+      COMPOSITE_TEXT | COMPOSITE_DOUBLEBUFFER,
+      COMPOSITE_TEXT | COMPOSITE_INTERLACE,
+  };
+  unsigned runs = 0;
+  for (size_t d = 0; d < NUM_DISPLAYS; d++) {
+    std::vector<uint16_t> ref, frame;
+    for (size_t i = 0; i < sizeof same; i++, runs++) {
+      if (runOne(d, same[i], i ? frame : ref) && i && (frame != ref))
+        fail(displays[d].name, "%s output differs from flags 0",
+             flagString(same[i]));
+    }
+    for (size_t i = 0; i < sizeof sameInterlaced; i++, runs++) {
+      if (runOne(d, sameInterlaced[i], i ? frame : ref) && i &&
+          (frame != ref))
+        fail(displays[d].name, "%s output differs from INTERLACE",
+             flagString(sameInterlaced[i]));
+    }
+    for (size_t i = 0; i < sizeof text; i++, runs++)
+      runOne(d, text[i], frame);
+    checkDrawOrder(d, 0);
+    checkDrawOrder(d, COMPOSITE_PACKED8);
+    checkPreEmphasis(d);
+    checkInterruptSwap(d, 0);
+    checkInterruptSwap(d, COMPOSITE_PACKED8);
+    checkInterruptSwap(d, COMPOSITE_TEXT);
+    checkLateSwap(d, 0);
+    checkLateSwap(d, COMPOSITE_COMPACT);
+    checkRestart(d);
+    runs += 15; // (Swap and pre-emphasis checks are two runs or more)
+    runs += checkAcrossModes(d, "raster with blank lines", setBlankRaster);
+    runs += checkAcrossModes(d, "setRowHeight()", setShortRows);
+    runs += checkScroll(d);
+    runs += checkSprites(d);
+    runs += compareModes(d, "RLE", drawBothRLE, drawBothDirectly);
+    runs += compareModes(d, "canvas", drawCanvas, drawCanvasDirectly);
+    runs += checkAcrossModes(d, "setLevels()", setWideLevels);
+    resetLevels();
+    checkLevels(d, 0);
+    checkLevels(d, COMPOSITE_PACKED8);
+    runs += 4;
+  }
+  printf("%u runs, %u failure(s)%s\n", runs, videoErrors,
+         COMPOSITE_VSYNC_RAM ? " (COMPOSITE_VSYNC_RAM)" : "");
+  return videoErrors ? 1 : 0;
+}
+
+// BENCHMARKS --------------------------------------------------------------
+
+static double nanos(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+// Time code(i) for i = 0 to n-1 (video not advancing meanwhile), print
+// the average
+template <typename F> static void timeIt(const char *label, int n, F code) {
+  auto t = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++)
+    code(i);
+  printf("  %-22s %10.0f ns\n", label, nanos(t) / n);
+}
+
+static void benchOne(size_t d, uint8_t flags) {
+  printf("%s %s\n", displays[d].name, flagString(flags));
+  Adafruit_CompositeVideo *display = displays[d].make();
+  timeIt("begin() + end()", 200, [&](int) {
+    display->begin(flags);
+    display->end();
+  });
+  if (!display->begin(flags)) {
+    printf("  begin() failed\n");
+    delete display;
+    return;
+  }
+  int16_t w = display->width(), h = display->height();
+  GFXcanvas8 canvas(w, h);
+  for (int16_t y = 0; y < h; y++) {
+    for (int16_t x = 0; x < w; x++)
+      canvas.drawPixel(x, y, x * 255 / (w - 1));
+  }
+  timeIt("drawPixel", 100000,
+         [&](int i) { display->drawPixel(i % w, (i / w) % h, i); });
+  timeIt("fillScreen", 2000, [&](int i) { display->fillScreen(i); });
+  timeIt("clear", 2000, [&](int) { display->clear(); });
+  timeIt("drawGrayscaleBitmap", 2000, [&](int) {
+    display->drawGrayscaleBitmap(0, 0, canvas.getBuffer(), w, h);
+  });
+  timeIt("print", 2000, [&](int) {
+    display->setCursor(0, 0);
+    display->print("Hello World");
+  });
+  timeIt("gradient (scrollText)", 2000, [&](int) {
+    for (int16_t y = 0; y < h; y++)
+      display->drawLine(0, y, w - 1, y, y * 5);
+  });
+  // Interrupt work per field (expanding lines, in packed and text modes)
+  simCallbackNanos = 0;
+  uint32_t start = display->getStats().fields, fields;
+  while ((fields = display->getStats().fields - start) < 120)
+    simRun(UINT32_MAX, true);
+  printf("  %-22s %10.0f ns\n", "interrupts per field",
+         (double)simCallbackNanos / fields);
+  display->end();
+  delete display;
+}
+
+static int bench(void) {
+  benchOne(0, 0);
+  benchOne(0, COMPOSITE_PACKED8);
+  benchOne(0, COMPOSITE_PACKED4);
+  benchOne(3, 0);
+  benchOne(3, COMPOSITE_PACKED8);
+  benchOne(2, COMPOSITE_TEXT);
+  return 0;
+}
+
+// WAVEFORM DUMP -----------------------------------------------------------
+
+static int dump(const char *className, const char *flagList,
+                const char *name) {
+  size_t d = 0;
+  while ((d < NUM_DISPLAYS) && strcmp(displays[d].name, className))
+    d++;
+  int flags = parseFlags(flagList);
+  if ((d >= NUM_DISPLAYS) || (flags < 0)) {
+    fprintf(stderr, "Unknown display class or flags\n");
+    return 2;
+  }
+  Adafruit_CompositeVideo *display = displays[d].make();
+  std::vector<uint16_t> frame;
+  if (!display->begin(flags)) {
+    fprintf(stderr, "begin() failed\n");
+    return 1;
+  }
+  drawTestImage(display);
+  if (flags & COMPOSITE_DOUBLEBUFFER)
+    display->swapBuffers(true);
+  bool ok = captureFrame(display, frame);
+  display->end();
+  if (!ok) {
+    fprintf(stderr, "No complete frame output\n");
+    return 1;
+  }
+  uint8_t rpc = videoSpec[displays[d].mode].rowPixelClocks;
+  char path[256];
+  snprintf(path, sizeof path, "%s.pgm", name);
+  FILE *fp = fopen(path, "wb");
+  if (!fp) {
+    perror(path);
+    return 1;
+  }
+  fprintf(fp, "P5\n%u %u\n255\n", rpc, (unsigned)(frame.size() / rpc));
+  for (size_t i = 0; i < frame.size(); i++) // White level = 255
+    fputc((frame[i] >= NW) ? 255 : frame[i] * 255 / NW, fp);
+  fclose(fp);
+  snprintf(path, sizeof path, "%s.csv", name);
+  if (!(fp = fopen(path, "w"))) {
+    perror(path);
+    return 1;
+  }
+  fprintf(fp, "sample,dac\n");
+  for (size_t i = 0; i < frame.size(); i++)
+    fprintf(fp, "%u,%u\n", (unsigned)i, frame[i]);
+  fclose(fp);
+  printf("%s %s: %u lines of %u samples\n", className, flagString(flags),
+         (unsigned)(frame.size() / rpc), rpc);
+  delete display;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  simInitFont();
+  if ((argc == 2) && !strcmp(argv[1], "check"))
+    return check();
+  if ((argc == 2) && !strcmp(argv[1], "bench"))
+    return bench();
+  if ((argc == 5) && !strcmp(argv[1], "dump"))
+    return dump(argv[2], argv[3], argv[4]);
+  fprintf(stderr, "Usage: %s check | bench | dump CLASS FLAGS NAME\n",
+          argv[0]);
+  return 2;
+}
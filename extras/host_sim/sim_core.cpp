@@ -0,0 +1,591 @@
+// Host implementations behind the stand-in Arduino.h, Adafruit_GFX.h and
+// Adafruit_ZeroDMA.h headers, plus the DMAC model (see sim_core.h).
+
+#include "sim_core.h"
+#include <Adafruit_GFX.h>
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+
+// REGISTERS ---------------------------------------------------------------
+
+Dmac simDMAC;
+Gclk simGCLK;
+Tc simTC3, simTC4, simTC5;
+Tcc simTCC0, simTCC1, simTCC2;
+Dac simDAC;
+
+// Base descriptor table shared by all channels, as Adafruit_ZeroDMA sets
+// up (only channel 0 is ever handed out here)
+static DmacDescriptor baseTable[12] __attribute__((aligned(16)));
+
+unsigned char font[256 * 5];
+
+// Made-up glyphs: the real ones don't matter for timing or checks, only
+// that characters differ and have some set pixels. Bit 7 stays clear, as
+// in the real font (the 8th row is the gap between lines of text).
+void simInitFont(void) {
+  for (int i = 0; i < 256 * 5; i++)
+    font[i] = (uint8_t)((i * 37 + (i / 5) * 11) ^ (i >> 3)) & 0x7F;
+}
+
+// ARDUINO CORE ------------------------------------------------------------
+
+void pinMode(int pin, int mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(int pin, int value) {
+  (void)pin;
+  (void)value;
+}
+
+void analogWriteResolution(int bits) { (void)bits; }
+
+void analogWrite(int pin, int value) {
+  if (pin == A0)
+    simDAC.DATA.reg = value;
+}
+
+// Timer ticks (at 48 MHz) per pixel clock, from whichever timer the
+// library enabled, or 1 if none.
+static uint32_t ticksPerBeat(void) {
+  Tc *tc[] = {TC3, TC4, TC5};
+  Tcc *tcc[] = {TCC0, TCC1, TCC2};
+  for (int i = 0; i < 3; i++) {
+    if (tc[i]->COUNT16.CTRLA.reg & TC_CTRLA_ENABLE)
+      return tc[i]->COUNT16.CC[0].reg + 1;
+    if (tcc[i]->CTRLA.reg & TCC_CTRLA_ENABLE)
+      return tcc[i]->PER.reg + 1;
+  }
+  return 1;
+}
+
+static uint64_t simTicks = 0; // 48 MHz ticks of simulated time
+
+uint32_t micros(void) { return (uint32_t)(simTicks / 48); }
+
+uint32_t millis(void) { return (uint32_t)(simTicks / 48000); }
+
+void delay(uint32_t ms) {
+  uint64_t end = simTicks + (uint64_t)ms * 48000;
+  while (simRunning() && (simTicks < end))
+    simRun(1000);
+  if (simTicks < end)
+    simTicks = end; // Time passes even with video stopped
+}
+
+void __WFE(void) {
+  if (simIPSR) { // Waiting on the DMA interrupt from inside it
+    fprintf(stderr, "FAIL: WFE in interrupt handler, would wait forever\n");
+    exit(1);
+  }
+  if (simRunning()) {
+    simRun(UINT32_MAX, true);
+    if (simWakeLate)
+      simRun(simWakeLate);
+  }
+}
+
+size_t Print::write(const uint8_t *buf, size_t n) {
+  size_t count = 0;
+  while (n--)
+    count += write(*buf++);
+  return count;
+}
+
+size_t Print::print(const char *s) {
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(long n) {
+  char buf[24];
+  snprintf(buf, sizeof buf, "%ld", n);
+  return print(buf);
+}
+
+size_t Print::print(unsigned long n) {
+  char buf[24];
+  snprintf(buf, sizeof buf, "%lu", n);
+  return print(buf);
+}
+
+// ADAFRUIT_GFX ------------------------------------------------------------
+// Same call structure as the real library (e.g. fillRect() is a series of
+// writeFastVLine()s), so overrides are reached the same way.
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : WIDTH(w), HEIGHT(h), _width(w), _height(h), cursor_x(0), cursor_y(0),
+      textcolor(0xFFFF), textbgcolor(0xFFFF), textsize_x(1), textsize_y(1),
+      rotation(0), wrap(true), _cp437(false) {}
+
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+  drawPixel(x, y, color);
+}
+
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                 uint16_t color) {
+  fillRect(x, y, w, h, color);
+}
+
+void Adafruit_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h,
+                                  uint16_t color) {
+  drawFastVLine(x, y, h, color);
+}
+
+void Adafruit_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w,
+                                  uint16_t color) {
+  drawFastHLine(x, y, w, color);
+}
+
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                             uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int16_t t;
+  if (steep) {
+    t = x0, x0 = y0, y0 = t;
+    t = x1, x1 = y1, y1 = t;
+  }
+  if (x0 > x1) {
+    t = x0, x0 = x1, x1 = t;
+    t = y0, y0 = y1, y1 = t;
+  }
+  int16_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep)
+      writePixel(y0, x0, color);
+    else
+      writePixel(x0, y0, color);
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+  rotation = r & 3;
+  _width = (rotation & 1) ? HEIGHT : WIDTH;
+  _height = (rotation & 1) ? WIDTH : HEIGHT;
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                 uint16_t color) {
+  startWrite();
+  writeLine(x, y, x, y + h - 1, color);
+  endWrite();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color) {
+  startWrite();
+  writeLine(x, y, x + w - 1, y, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  startWrite();
+  for (int16_t i = x; i < x + w; i++)
+    writeFastVLine(i, y, h, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            uint16_t color) {
+  if (x0 == x1) {
+    if (y0 > y1)
+      drawFastVLine(x0, y1, y0 - y1 + 1, color);
+    else
+      drawFastVLine(x0, y0, y1 - y0 + 1, color);
+  } else if (y0 == y1) {
+    if (x0 > x1)
+      drawFastHLine(x1, y0, x0 - x1 + 1, color);
+    else
+      drawFastHLine(x0, y0, x1 - x0 + 1, color);
+  } else {
+    startWrite();
+    writeLine(x0, y0, x1, y1, color);
+    endWrite();
+  }
+}
+
+void Adafruit_GFX::drawGrayscaleBitmap(int16_t x, int16_t y,
+                                       const uint8_t bitmap[], int16_t w,
+                                       int16_t h) {
+  startWrite();
+  for (int16_t j = 0; j < h; j++, y++) {
+    for (int16_t i = 0; i < w; i++)
+      writePixel(x + i, y, bitmap[j * w + i]);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap,
+                                       int16_t w, int16_t h) {
+  drawGrayscaleBitmap(x, y, (const uint8_t *)bitmap, w, h);
+}
+
+void Adafruit_GFX::drawGrayscaleBitmap(int16_t x, int16_t y,
+                                       const uint8_t bitmap[],
+                                       const uint8_t mask[], int16_t w,
+                                       int16_t h) {
+  int16_t bw = (w + 7) / 8; // Mask bitmask scanline pad = whole byte
+  startWrite();
+  for (int16_t j = 0; j < h; j++, y++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (mask[j * bw + i / 8] & (0x80 >> (i & 7)))
+        writePixel(x + i, y, bitmap[j * w + i]);
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap,
+                                       uint8_t *mask, int16_t w, int16_t h) {
+  drawGrayscaleBitmap(x, y, (const uint8_t *)bitmap, (const uint8_t *)mask,
+                      w, h);
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
+                            uint16_t color, uint16_t bg, uint8_t size) {
+  if ((x >= _width) || (y >= _height) || ((x + 6 * size - 1) < 0) ||
+      ((y + 8 * size - 1) < 0))
+    return;
+  if (!_cp437 && (c >= 176))
+    c++; // Handle 'classic' charset behavior
+  startWrite();
+  for (int8_t i = 0; i < 5; i++) {
+    uint8_t line = pgm_read_byte(&font[c * 5 + i]);
+    for (int8_t j = 0; j < 8; j++, line >>= 1) {
+      if (line & 1) {
+        if (size == 1)
+          writePixel(x + i, y + j, color);
+        else
+          writeFillRect(x + i * size, y + j * size, size, size, color);
+      } else if (bg != color) {
+        if (size == 1)
+          writePixel(x + i, y + j, bg);
+        else
+          writeFillRect(x + i * size, y + j * size, size, size, bg);
+      }
+    }
+  }
+  if (bg != color) { // If opaque, draw vertical line for last column
+    if (size == 1)
+      writeFastVLine(x + 5, y, 8, bg);
+    else
+      writeFillRect(x + 5 * size, y, size, 8 * size, bg);
+  }
+  endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += textsize_y * 8;
+  } else if (c != '\r') {
+    if (wrap && ((cursor_x + textsize_x * 6) > _width)) {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    }
+    drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x);
+    cursor_x += textsize_x * 6;
+  }
+  return 1;
+}
+
+GFXcanvas8::GFXcanvas8(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  buffer = (uint8_t *)calloc(w, h);
+}
+
+GFXcanvas8::~GFXcanvas8(void) { free(buffer); }
+
+void GFXcanvas8::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (!buffer || (x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    return;
+  int16_t t;
+  switch (rotation) {
+  case 1:
+    t = x, x = WIDTH - 1 - y, y = t;
+    break;
+  case 2:
+    x = WIDTH - 1 - x, y = HEIGHT - 1 - y;
+    break;
+  case 3:
+    t = x, x = y, y = HEIGHT - 1 - t;
+    break;
+  }
+  buffer[x + y * WIDTH] = color;
+}
+
+void GFXcanvas8::fillScreen(uint16_t color) {
+  if (buffer)
+    memset(buffer, color, WIDTH * HEIGHT);
+}
+
+// ADAFRUIT_ZERODMA --------------------------------------------------------
+
+Adafruit_ZeroDMA::Adafruit_ZeroDMA(void)
+    : trigger(0), action(DMA_TRIGGER_ACTON_BEAT), channel(0xFF) {
+  memset(callback, 0, sizeof callback);
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::allocate(void) {
+  if (channel != 0xFF)
+    return DMA_STATUS_BUSY;
+  DMAC->BASEADDR.reg = simDmaAddr(baseTable);
+  channel = 0;
+  return DMA_STATUS_OK;
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::free(void) {
+  if (channel == 0xFF)
+    return DMA_STATUS_ERR_NOT_INITIALIZED;
+  simStop();
+  channel = 0xFF;
+  return DMA_STATUS_OK;
+}
+
+ZeroDMAstatus Adafruit_ZeroDMA::startJob(void) {
+  if (channel == 0xFF)
+    return DMA_STATUS_ERR_NOT_INITIALIZED;
+  simStart(this);
+  return DMA_STATUS_OK;
+}
+
+void Adafruit_ZeroDMA::abort(void) { simStop(); }
+
+void Adafruit_ZeroDMA::setCallback(void (*cb)(Adafruit_ZeroDMA *),
+                                   dma_callback_type type) {
+  if (type < DMA_CALLBACK_N)
+    callback[type] = cb;
+}
+
+DmacDescriptor *Adafruit_ZeroDMA::addDescriptor(void *src, void *dst,
+                                                uint32_t count,
+                                                dma_beat_size size,
+                                                bool srcInc, bool dstInc) {
+  if (channel == 0xFF)
+    return NULL;
+  DmacDescriptor *desc = &baseTable[channel];
+  desc->BTCTRL.bit.VALID = true;
+  desc->BTCTRL.bit.BEATSIZE = size;
+  desc->BTCTRL.bit.SRCINC = srcInc;
+  desc->BTCTRL.bit.DSTINC = dstInc;
+  desc->BTCNT.reg = count;
+  desc->SRCADDR.reg = simDmaAddr(src);
+  desc->DSTADDR.reg = simDmaAddr(dst);
+  desc->DESCADDR.reg = 0;
+  return desc;
+}
+
+// DMAC MODEL --------------------------------------------------------------
+
+std::vector<uint16_t> *simCapture = NULL;
+uint64_t simBeats = 0, simCallbackNanos = 0;
+uint32_t simErrors = 0;
+uint32_t simIPSR = 0;
+uint32_t simWakeLate = 0;
+char simFirstError[128] = "";
+
+static Adafruit_ZeroDMA *job = NULL; // NULL when not running
+static DmacDescriptor active;        // Current descriptor (write-back copy)
+static uint32_t beat;                // Next beat within it
+
+void simError(const char *fmt, ...) {
+  if (!simErrors++) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(simFirstError, sizeof simFirstError, fmt, args);
+    va_end(args);
+  }
+}
+
+// DMA ADDRESSES -----------------------------------------------------------
+// Descriptors hold 32-bit addresses, host pointers are 64 bits. Each 1 MB
+// window of host memory handed to the DMA is given a 32-bit slot, keeping
+// offsets within it (and so alignment). A buffer can straddle two windows,
+// whose slots must then be adjacent: new windows take every third slot,
+// leaving room either side for their neighbors.
+
+#define WINDOW_BITS 20
+#define NUM_SLOTS (1 << (32 - WINDOW_BITS))
+static uintptr_t slotWindow[NUM_SLOTS]; // Host window + 1, 0 = free
+static std::unordered_map<uintptr_t, uint32_t> windowSlot;
+static uint32_t nextSlot = 2; // Slot 0 is NULL, 1 is left for a neighbor
+
+static uint32_t claimSlot(uintptr_t w, uint32_t s) {
+  slotWindow[s] = w + 1;
+  windowSlot[w] = s;
+  return s;
+}
+
+uint32_t simDmaAddr(const volatile void *p) {
+  if (!p)
+    return 0;
+  uintptr_t w = (uintptr_t)p >> WINDOW_BITS;
+  uint32_t offset = (uintptr_t)p & ((1 << WINDOW_BITS) - 1), s;
+  auto i = windowSlot.find(w);
+  if (i != windowSlot.end()) {
+    s = i->second;
+  } else if (((i = windowSlot.find(w - 1)) != windowSlot.end()) &&
+             (i->second + 1 < NUM_SLOTS) && !slotWindow[i->second + 1]) {
+    s = claimSlot(w, i->second + 1);
+  } else if (((i = windowSlot.find(w + 1)) != windowSlot.end()) &&
+             (i->second > 1) && !slotWindow[i->second - 1]) {
+    s = claimSlot(w, i->second - 1);
+  } else if (nextSlot < NUM_SLOTS) {
+    s = claimSlot(w, nextSlot);
+    nextSlot += 3;
+  } else {
+    fprintf(stderr, "FAIL: out of 32-bit DMA address slots\n");
+    exit(1);
+  }
+  return (s << WINDOW_BITS) | offset;
+}
+
+void *simDmaPtr(uint32_t a) {
+  uintptr_t w = slotWindow[a >> WINDOW_BITS];
+  if (!w)
+    return NULL; // Never handed out: a bad address
+  return (void *)(((w - 1) << WINDOW_BITS) |
+                  (a & ((1 << WINDOW_BITS) - 1)));
+}
+
+// Host pointer for n bytes the DMA reaches from a, NULL if they're not
+// all mapped, contiguously (n = 0 checks just the first byte)
+static void *addr(uint32_t a, uint32_t n = 0) {
+  uint8_t *p = (uint8_t *)simDmaPtr(a);
+  if (n && p && ((uint8_t *)simDmaPtr(a + n - 1) != p + n - 1))
+    return NULL;
+  return p;
+}
+
+// Fetch a descriptor, as the DMAC does at the start of each block. A bad
+// one is a transfer error: the channel stops, and the error callback runs.
+static bool fetch(uint32_t a) {
+  if (!a) {
+    job = NULL; // End of list, channel stops (video never does this)
+    return false;
+  }
+  bool ok = true;
+  if (a & 15) {
+    simError("descriptor at %08X not 16-byte aligned", a);
+    ok = false;
+  } else if (!addr(a, sizeof active)) {
+    simError("descriptor at %08X not in memory", a);
+    ok = false;
+  } else {
+    memcpy((void *)&active, addr(a), sizeof active);
+    uint8_t size = 1 << active.BTCTRL.bit.BEATSIZE;
+    uint32_t src = active.SRCADDR.reg, dst = active.DSTADDR.reg;
+    if (active.BTCTRL.bit.SRCINC)
+      src -= active.BTCNT.reg * size; // SRCADDR is the END address
+    if (active.BTCTRL.bit.DSTINC)
+      dst -= active.BTCNT.reg * size;
+    if (!active.BTCTRL.bit.VALID) {
+      simError("descriptor at %08X not valid", a);
+      ok = false;
+    } else if (!active.BTCNT.reg) {
+      simError("descriptor at %08X has zero beats", a);
+      ok = false;
+    } else if ((src | dst) & (size - 1)) {
+      simError("descriptor at %08X: %d-byte beats from %08X to %08X", a,
+               size, src, dst);
+      ok = false;
+    } else if ((dst == simDmaAddr(&DAC->DATA.reg)) && (size != 2)) {
+      simError("descriptor at %08X: %d-byte beats to DAC", a, size);
+      ok = false;
+    } else if (!addr(src, active.BTCTRL.bit.SRCINC
+                              ? active.BTCNT.reg * size
+                              : size) ||
+               !addr(dst, active.BTCTRL.bit.DSTINC
+                              ? active.BTCNT.reg * size
+                              : size)) {
+      simError("descriptor at %08X: %08X or %08X not in memory", a, src,
+               dst);
+      ok = false;
+    }
+  }
+  beat = 0;
+  if (!ok) {
+    Adafruit_ZeroDMA *dma = job;
+    job = NULL;
+    if (dma->callback[DMA_CALLBACK_TRANSFER_ERROR]) {
+      simIPSR = DMAC_IPSR;
+      (*dma->callback[DMA_CALLBACK_TRANSFER_ERROR])(dma);
+      simIPSR = 0;
+    }
+  }
+  return ok;
+}
+
+void simStart(Adafruit_ZeroDMA *dma) {
+  job = dma;
+  DmacDescriptor *base = (DmacDescriptor *)addr(DMAC->BASEADDR.reg);
+  (void)fetch(simDmaAddr(&base[dma->getChannel()]));
+}
+
+void simStop(void) { job = NULL; }
+
+bool simRunning(void) { return job != NULL; }
+
+uint32_t simRun(uint32_t beats, bool stopAtInterrupt) {
+  uint32_t total = 0, ticks = ticksPerBeat();
+  while (job && (total < beats)) {
+    uint8_t size = 1 << active.BTCTRL.bit.BEATSIZE;
+    uint32_t count = active.BTCNT.reg;
+    uint32_t src = active.SRCADDR.reg, dst = active.DSTADDR.reg;
+    if (active.BTCTRL.bit.SRCINC)
+      src -= count * size;
+    if (active.BTCTRL.bit.DSTINC)
+      dst -= count * size;
+    bool toDAC = dst == simDmaAddr(&DAC->DATA.reg);
+    uint32_t done = 0;
+    for (; (beat < count) && (total < beats); beat++, done++, total++) {
+      uint32_t s = src + (active.BTCTRL.bit.SRCINC ? beat * size : 0);
+      uint32_t d = dst + (active.BTCTRL.bit.DSTINC ? beat * size : 0);
+      uint32_t v = (size == 1)   ? *(uint8_t *)addr(s)
+                   : (size == 2) ? *(uint16_t *)addr(s)
+                                 : *(uint32_t *)addr(s);
+      if (toDAC) {
+        DAC->DATA.reg = v;
+        if (simCapture)
+          simCapture->push_back(v);
+      } else {
+        memcpy(addr(d), &v, size); // Little-endian, low bytes first
+      }
+    }
+    simBeats += done;
+    simTicks += (uint64_t)done * ticks;
+    if (beat < count)
+      break; // Out of beats mid-block
+    // Block done. The DMAC fetches the next descriptor right away, so the
+    // interrupt handler sees the DMA already on its way through that one.
+    bool irq = active.BTCTRL.bit.BLOCKACT & DMA_BLOCK_ACTION_INT;
+    Adafruit_ZeroDMA *dma = job;
+    (void)fetch(active.DESCADDR.reg);
+    if (irq && dma->callback[DMA_CALLBACK_TRANSFER_DONE]) {
+      auto t = std::chrono::steady_clock::now();
+      simIPSR = DMAC_IPSR;
+      (*dma->callback[DMA_CALLBACK_TRANSFER_DONE])(dma);
+      simIPSR = 0;
+      simCallbackNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - t)
+                              .count();
+      if (stopAtInterrupt)
+        break;
+    }
+  }
+  return total;
+}
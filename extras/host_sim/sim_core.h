@@ -0,0 +1,37 @@
+// Model of the SAMD21 DMAC as Adafruit_CompositeVideo uses it: one
+// channel, one beat per pixel clock, walking the descriptor list through
+// memory the way the hardware does. DAC writes are collected as samples,
+// other transfers (e.g. the field-end flag) are carried out in memory.
+// Anything the real DMAC would choke on (misaligned descriptors or
+// beats, invalid descriptors, non-halfword DAC writes) is counted as an
+// error instead.
+
+#ifndef _HOST_SIM_CORE_H_
+#define _HOST_SIM_CORE_H_
+
+/// @cond HOST_SIM
+
+#include <Adafruit_ZeroDMA.h>
+#include <vector>
+
+void simStart(Adafruit_ZeroDMA *dma); // Load channel's base descriptor
+void simStop(void);                   // Abort, as dma.abort()
+bool simRunning(void);
+
+// Run the DMA for up to 'beats' pixel clocks, or until (and including)
+// the next interrupt if stopAtInterrupt. Returns beats actually run.
+uint32_t simRun(uint32_t beats, bool stopAtInterrupt = false);
+
+extern std::vector<uint16_t> *simCapture; // If set, DAC samples go here
+extern uint64_t simBeats;                  // Total beats output
+extern uint64_t simCallbackNanos;          // Host time spent in interrupts
+extern uint32_t simWakeLate;               // Beats run after WFE's interrupt
+extern uint32_t simErrors;                 // Count of DMAC errors
+extern char simFirstError[128];            // and the first one
+
+void simError(const char *fmt, ...);
+void simInitFont(void);
+
+/// @endcond
+
+#endif // _HOST_SIM_CORE_H_
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""
+Encode grayscale images as an Adafruit_CompositeVideo frame stream.
+
+Each input image is one frame and must be exactly the display size
+(e.g. 40x24). Binary PGM (P5) is read directly; other formats need Pillow.
+
+Output is a CompositeStreamHeader (see Adafruit_CompositeVideo.h)
+followed by the frames, either as a C header holding a PROGMEM array
+(.h, for drawRLEFrame() from internal flash) or raw bytes (anything else,
+e.g. to write to SPI flash or SD).
+
+Formats:
+  rle      Run-length/delta frames for drawRLEFrame() (default)
+  packed8  8 bits/pixel, for getFrameData() with COMPOSITE_PACKED8
+  packed4  4 bits/pixel, for getFrameData() with COMPOSITE_PACKED4
+
+RLE frames are a series of codes covering the frame's pixels in order,
+left to right and top to bottom, running on from one row to the next:
+  0x00-0x7F  Skip 1-128 pixels, unchanged from the previous frame
+  0x80-0xBF  Run of 1-64 pixels, value in next byte
+  0xC0-0xFF  1-64 literal pixel values follow
+The first frame never skips, so playback can loop back to it.
+
+Example:
+  python3 rle_encode.py -o animation.h frame*.pgm
+"""
+
+import argparse
+import struct
+import sys
+
+STREAM_VERSION = 1  # COMPOSITE_STREAM_VERSION
+FORMATS = {"packed4": 0x04, "packed8": 0x08, "rle": 0x80}
+
+
+def read_pgm(path):
+    """Return (width, height, pixels) from a binary PGM file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:  # Magic, width, height, maxval
+        while data[pos : pos + 1].isspace():
+            pos += 1
+        if data[pos : pos + 1] == b"#":  # Comment to end of line
+            pos = data.index(b"\n", pos)
+            continue
+        start = pos
+        while not data[pos : pos + 1].isspace():
+            pos += 1
+        fields.append(data[start:pos])
+    if fields[0] != b"P5":
+        raise ValueError("not a binary PGM file")
+    width, height, maxval = (int(x) for x in fields[1:])
+    if maxval > 255:
+        raise ValueError("16-bit PGM not supported")
+    pixels = data[pos + 1 : pos + 1 + width * height]
+    if maxval != 255:
+        pixels = bytes(p * 255 // maxval for p in pixels)
+    return width, height, pixels
+
+
+def read_image(path):
+    """Return (width, height, pixels) as 8-bit grayscale."""
+    try:
+        return read_pgm(path)
+    except ValueError:
+        pass
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit(path + ": not a binary PGM, and Pillow isn't installed")
+    with Image.open(path) as img:
+        img = img.convert("L")
+        return img.width, img.height, img.tobytes()
+
+
+def encode_rle(pixels, prev):
+    """Encode one frame, skipping pixels unchanged from prev (if any)."""
+    out = bytearray()
+    i, n = 0, len(pixels)
+    while i < n:
+        # Skip: pixels same as the previous frame
+        j = i
+        while prev and j < n and j - i < 128 and pixels[j] == prev[j]:
+            j += 1
+        if j > i:
+            out.append(j - i - 1)
+            i = j
+            continue
+        # Run: three or more equal pixels
+        j = i
+        while j < n and j - i < 64 and pixels[j] == pixels[i]:
+            j += 1
+        if j - i >= 3:
+            out += bytes((0x80 | (j - i - 1), pixels[i]))
+            i = j
+            continue
+        # Literal: up to the next skip or run
+        j = i
+        while j < n and j - i < 64:
+            if prev and pixels[j] == prev[j]:
+                break
+            if pixels[j : j + 3] == bytes([pixels[j]]) * 3:
+                break
+            j += 1
+        out.append(0xC0 | (j - i - 1))
+        out += pixels[i:j]
+        i = j
+    return bytes(out)
+
+
+def encode_packed4(pixels, width, height):
+    """Two pixels per byte, left pixel in high nibble, rows byte-aligned."""
+    out = bytearray()
+    for y in range(height):
+        row = pixels[y * width : (y + 1) * width]
+        if width & 1:
+            row += b"\0"
+        for x in range(0, len(row), 2):
+            out.append((row[x] & 0xF0) | (row[x + 1] >> 4))
+    return bytes(out)
+
+
+def write_header(path, name, data):
+    """Write data as a PROGMEM array, same layout as Adafruit_GFX fonts."""
+    with open(path, "w") as f:
+        f.write("// Generated by rle_encode.py\n\n")
+        f.write("const uint8_t %s[] PROGMEM = {\n" % name)
+        for i in range(0, len(data), 12):
+            f.write(
+                "    "
+                + ", ".join("0x%02X" % b for b in data[i : i + 12])
+                + ("};\n" if i + 12 >= len(data) else ",\n")
+            )
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("images", nargs="+", help="frames, in order")
+    parser.add_argument("-o", "--output", required=True, help=".h or binary")
+    parser.add_argument("-f", "--format", choices=FORMATS, default="rle")
+    parser.add_argument("-n", "--name", default="animation", help="C array name")
+    args = parser.parse_args()
+
+    frames = [read_image(path) for path in args.images]
+    width, height = frames[0][:2]
+    for path, frame in zip(args.images, frames):
+        if frame[:2] != (width, height):
+            sys.exit("%s: size differs from first frame" % path)
+    if len(frames) > 65535:
+        sys.exit("too many frames")
+
+    encoded, prev = [], None
+    for _, _, pixels in frames:
+        if args.format == "rle":
+            encoded.append(encode_rle(pixels, prev))
+            prev = pixels
+        elif args.format == "packed8":
+            encoded.append(pixels)
+        else:
+            encoded.append(encode_packed4(pixels, width, height))
+
+    frame_bytes = 0 if args.format == "rle" else len(encoded[0])
+    header = struct.pack(
+        "<4sBBHHHI",
+        b"CVID",
+        STREAM_VERSION,
+        FORMATS[args.format],
+        width,
+        height,
+        len(frames),
+        frame_bytes,
+    )
+    data = header + b"".join(encoded)
+
+    if args.output.endswith(".h"):
+        write_header(args.output, args.name, data)
+    else:
+        with open(args.output, "wb") as f:
+            f.write(data)
+    raw = width * height * len(frames)
+    print(
+        "%d frames, %d bytes (%d%% of %d uncompressed)"
+        % (len(frames), len(data), len(data) * 100 // raw, raw)
+    )
+
+
+if __name__ == "__main__":
+    main()